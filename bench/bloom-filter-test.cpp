@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/bloom_filter.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto size: opts.sizes) {
+        // Inserted keys have an even second member, queried ones an odd
+        // one, so that every positive answer is a false positive
+        auto raw = bench::random(size, opts.seed);
+        std::vector<pair_t> keys, queries;
+        for (auto const& value: raw.values) {
+            keys.emplace_back(std::uint32_t(value.first), std::uint32_t(2 * value.second));
+            queries.emplace_back(std::uint32_t(value.second), std::uint32_t(2 * value.first + 1));
+        }
+
+        for (int bits_per_element: { 6, 8, 10, 12, 16 }) {
+            cruft::pair_bloom_filter<std::uint32_t, std::uint32_t> filter(size, bits_per_element);
+            filter.insert(keys.begin(), keys.end());
+            auto suffix = '-' + std::to_string(bits_per_element) + "bpe";
+            auto bytes = static_cast<double>(filter.size_in_bytes()) / static_cast<double>(size);
+
+            std::size_t positives = 0;
+            runner.run({ "cruft", "uint32", "random", "contains" + suffix, size }, bench::no_setup, [&] {
+                for (auto const& query: queries) {
+                    positives += filter.contains(query);
+                }
+            });
+            std::cerr << "positives: " << positives << '\n';
+
+            bench::configuration batched{ "cruft", "uint32", "random", "contains_batch" + suffix, size };
+            if (runner.selected(batched)) {
+                std::vector<unsigned char> results(size);
+                auto res = runner.measure(batched, bench::no_setup, [&] {
+                    filter.contains(queries.begin(), queries.end(), results.begin());
+                });
+                auto false_positives = std::count(results.begin(), results.end(), 1);
+                res.metrics.push_back({ "false_positive_rate",
+                                        static_cast<double>(false_positives) / static_cast<double>(size), 0.0 });
+                res.metrics.push_back({ "bytes", bytes, 0.0 });
+                runner.write(batched, std::move(res));
+            }
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/concurrent_hash_set.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+struct std_pair_hash
+{
+    auto operator()(pair_t const& value) const noexcept
+        -> std::size_t
+    {
+        return cruft::pair_hash{}(value);
+    }
+};
+
+// Baseline: the mutex-protected set that the concurrent set replaces
+class locked_set
+{
+    public:
+
+        explicit locked_set(std::size_t capacity)
+        {
+            set_.reserve(capacity);
+        }
+
+        auto insert(pair_t const& value)
+            -> bool
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return set_.insert(value).second;
+        }
+
+    private:
+
+        std::mutex mutex_;
+        std::unordered_set<pair_t, std_pair_hash> set_;
+};
+
+// Every thread deduplicates its own slice of the events in a set
+// created with the given capacity before each run
+template<typename Set>
+auto bench_set(bench::runner& runner, bench::configuration const& config,
+               std::vector<pair_t> const& events, std::size_t nb_threads, std::size_t capacity)
+    -> void
+{
+    std::optional<Set> set;
+    std::atomic<std::size_t> inserted(0);
+    auto slice = events.size() / nb_threads;
+
+    runner.run_threads(
+        config,
+        [&] {
+            set.reset();
+            set.emplace(capacity);
+        },
+        [&] {
+            std::atomic<bool> go(false);
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0 ; t < nb_threads ; ++t) {
+                threads.emplace_back([&, t] {
+                    while (not go.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    std::size_t count = 0;
+                    auto first = events.begin() + t * slice;
+                    for (auto it = first ; it != first + slice ; ++it) {
+                        count += set->insert(*it);
+                    }
+                    inserted += count;
+                });
+            }
+            go.store(true, std::memory_order_release);
+            for (auto& thread: threads) {
+                thread.join();
+            }
+        }
+    );
+    std::cerr << "inserted: " << inserted << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+    auto max_threads = std::thread::hardware_concurrency();
+    std::cerr << "hardware threads: " << max_threads << '\n';
+
+    // The distributions with few distinct pairs make most of the
+    // insertions fail, the others mostly insert new pairs
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto events = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+            for (std::size_t nb_threads = 1 ; nb_threads <= max_threads ; nb_threads *= 2) {
+                auto type = "uint32-" + std::to_string(nb_threads) + "threads";
+                using set_t = cruft::concurrent_pair_set<std::uint32_t, std::uint32_t>;
+                bench_set<locked_set>(runner, { "baseline", type, distribution.name, "locked_set", size },
+                                      events, nb_threads, size);
+                bench_set<set_t>(runner, { "cruft", type, distribution.name, "concurrent_pair_set", size },
+                                 events, nb_threads, size);
+                // Start small to measure the cost of cooperative resizing
+                bench_set<set_t>(runner, { "cruft", type, distribution.name, "concurrent_pair_set_growing", size },
+                                 events, nb_threads, 1024);
+            }
+        }
+    }
+}
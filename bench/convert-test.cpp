@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/convert.h>
+#include "distributions.h"
+#include "harness.h"
+
+template<typename T>
+auto bench_type(char const* type_name, bench::runner& runner)
+    -> void
+{
+    auto const& opts = runner.opts();
+    for (auto size: opts.sizes) {
+        auto pairs = bench::make_pairs<std::pair<T, T>>(bench::random(size, opts.seed));
+        std::vector<std::pair<T, T>> pairs_copy(size);
+        std::vector<cruft::tight_pair<T, T>> tight_pairs(size);
+
+        runner.run({ "cruft", type_name, "random", "std_to_tight", size }, bench::no_setup, [&] {
+            cruft::convert(pairs.data(), pairs.data() + size, tight_pairs.data());
+        });
+        runner.run({ "cruft", type_name, "random", "tight_to_std", size }, bench::no_setup, [&] {
+            cruft::convert(tight_pairs.data(), tight_pairs.data() + size, pairs_copy.data());
+        });
+        // Reference: plain copy without conversion
+        runner.run({ "std", type_name, "random", "copy", size }, bench::no_setup, [&] {
+            std::copy(pairs.begin(), pairs.end(), pairs_copy.begin());
+        });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    bench_type<std::uint8_t>("uint8", runner);
+    bench_type<std::uint16_t>("uint16", runner);
+    bench_type<std::uint32_t>("uint32", runner);
+    bench_type<std::uint64_t>("uint64", runner);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/dary_heap.h>
+#include "distributions.h"
+#include "harness.h"
+
+// Scheduler-like "hold" workload: the heap is filled with (deadline, task id)
+// pairs, then the earliest task is repeatedly popped and rescheduled later
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+template<typename Heap>
+auto bench_heap(bench::runner& runner, bench::configuration const& config,
+                std::vector<pair_t> const& tasks)
+    -> void
+{
+    auto size = config.size;
+    Heap heap;
+    std::mt19937_64 engine(runner.opts().seed);
+    runner.run(
+        config,
+        [&] {
+            heap = Heap();
+            for (auto const& task: tasks) {
+                heap.push(task);
+            }
+        },
+        [&] {
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                using cruft::get;
+                pair_t task = heap.top();
+                heap.pop();
+                heap.push(pair_t(get<0>(task) + std::uint32_t(engine() % size), get<1>(task)));
+            }
+        }
+    );
+}
+
+int main(int argc, char* argv[])
+{
+    // 10^8 elements need close to 2 GiB of memory between the heap
+    // and its initial content
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto tasks = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+
+            using queue_t = std::priority_queue<pair_t, std::vector<pair_t>, std::greater<>>;
+            bench_heap<queue_t>(runner, { "std", "uint32", distribution.name, "priority_queue", size }, tasks);
+            bench_heap<cruft::dary_heap<pair_t, 2>>(runner, { "cruft", "uint32", distribution.name, "dary_heap<2>", size }, tasks);
+            bench_heap<cruft::dary_heap<pair_t, 4>>(runner, { "cruft", "uint32", distribution.name, "dary_heap<4>", size }, tasks);
+            bench_heap<cruft::dary_heap<pair_t, 8>>(runner, { "cruft", "uint32", distribution.name, "dary_heap<8>", size }, tasks);
+        }
+    }
+}
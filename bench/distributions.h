@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_BENCH_DISTRIBUTIONS_H_
+#define CRUFT_TIGHT_PAIR_BENCH_DISTRIBUTIONS_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+// Input distributions for the benchmarks
+//
+// A distribution generates raw pairs of integers, each member
+// being smaller than a limit given alongside the values. The
+// raw pairs are then converted to the benchmarked pair type
+// with an order-preserving mapping onto the range of each
+// member type, so that sorted inputs stay sorted whatever the
+// member types, and std::pair and tight_pair get the same data.
+// Every distribution uses its own engine seeded by the caller,
+// the same seed always gives the same values.
+
+namespace bench
+{
+    struct raw_pairs
+    {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> values;
+        std::uint64_t first_limit;
+        std::uint64_t second_limit;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Conversion of raw values to members
+
+    template<typename T>
+    auto make_member(std::uint64_t value, std::uint64_t limit)
+        -> T
+    {
+        if constexpr (std::is_empty_v<T>) {
+            return T{};
+        } else {
+            using limits = std::numeric_limits<T>;
+            using unsigned_type = std::make_unsigned_t<T>;
+            constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<unsigned_type>::max());
+
+            // Spread the values over the range of the type when they
+            // don't fit in it, rounding preserves the order
+            std::uint64_t scaled = value;
+            if (limit - 1 > max) {
+                scaled = static_cast<std::uint64_t>(
+                    static_cast<long double>(value) / static_cast<long double>(limit) *
+                    (static_cast<long double>(max) + 1.0L)
+                );
+                scaled = std::min(scaled, max);
+            }
+            // Signed values start at the minimum of the type
+            return static_cast<T>(static_cast<unsigned_type>(scaled) + static_cast<unsigned_type>(limits::min()));
+        }
+    }
+
+    template<typename Pair>
+    auto make_pairs(raw_pairs const& raw)
+        -> std::vector<Pair>
+    {
+        using first_type = std::tuple_element_t<0, Pair>;
+        using second_type = std::tuple_element_t<1, Pair>;
+
+        std::vector<Pair> res;
+        res.reserve(raw.values.size());
+        for (auto const& value: raw.values) {
+            res.emplace_back(make_member<first_type>(value.first, raw.first_limit),
+                             make_member<second_type>(value.second, raw.second_limit));
+        }
+        return res;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Distributions
+
+    // First members cycle through 16 values and second members
+    // are distinct, in random order
+    inline auto shuffled(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        std::mt19937_64 engine(seed);
+        raw_pairs res{ {}, 16, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            res.values.emplace_back(i % 16, i);
+        }
+        std::shuffle(res.values.begin(), res.values.end(), engine);
+        return res;
+    }
+
+    // Both members uniformly distributed
+    inline auto random(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        std::mt19937_64 engine(seed);
+        std::uniform_int_distribution<std::uint64_t> dist(0, size - 1);
+        raw_pairs res{ {}, size, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            auto first = dist(engine);
+            res.values.emplace_back(first, dist(engine));
+        }
+        return res;
+    }
+
+    inline auto sorted(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        auto res = random(size, seed);
+        std::sort(res.values.begin(), res.values.end());
+        return res;
+    }
+
+    inline auto reverse_sorted(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        auto res = random(size, seed);
+        std::sort(res.values.begin(), res.values.end(), std::greater<>{});
+        return res;
+    }
+
+    // Only 16 distinct pairs
+    inline auto few_unique(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        std::mt19937_64 engine(seed);
+        std::uniform_int_distribution<std::uint64_t> dist(0, 3);
+        raw_pairs res{ {}, 4, 4 };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            auto first = dist(engine);
+            res.values.emplace_back(first, dist(engine));
+        }
+        return res;
+    }
+
+    // Every comparison has to look at the second members
+    inline auto all_equal_first(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        std::mt19937_64 engine(seed);
+        std::uniform_int_distribution<std::uint64_t> dist(0, size - 1);
+        raw_pairs res{ {}, 1, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            res.values.emplace_back(0, dist(engine));
+        }
+        return res;
+    }
+
+    // Ascending then descending
+    inline auto organ_pipe(std::size_t size, std::uint64_t)
+        -> raw_pairs
+    {
+        raw_pairs res{ {}, size, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            std::uint64_t value = i < size / 2 ? i : size - 1 - i;
+            res.values.emplace_back(value, value);
+        }
+        return res;
+    }
+
+    // 16 ascending runs
+    inline auto sawtooth(std::size_t size, std::uint64_t)
+        -> raw_pairs
+    {
+        std::size_t tooth = std::max<std::size_t>(1, (size + 15) / 16);
+        raw_pairs res{ {}, tooth, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            res.values.emplace_back(i % tooth, i);
+        }
+        return res;
+    }
+
+    // First members approximately follow a Zipf law of exponent
+    // 1: a few values are very frequent, most are rare. Sampled
+    // by inverting the continuous approximation of the CDF, which
+    // doesn't need a table as big as the range of values
+    inline auto zipfian(std::size_t size, std::uint64_t seed)
+        -> raw_pairs
+    {
+        std::mt19937_64 engine(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::uniform_int_distribution<std::uint64_t> dist(0, size - 1);
+        auto log_range = std::log(static_cast<double>(size) + 1.0);
+        raw_pairs res{ {}, size, size };
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            auto rank = static_cast<std::uint64_t>(std::exp(uniform(engine) * log_range)) - 1;
+            res.values.emplace_back(std::min<std::uint64_t>(rank, size - 1), dist(engine));
+        }
+        return res;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // All the distributions, for benchmarks iterating over them
+
+    struct named_distribution
+    {
+        char const* name;
+        raw_pairs (*generate)(std::size_t, std::uint64_t);
+    };
+
+    inline constexpr named_distribution distributions[] = {
+        { "shuffled", shuffled },
+        { "random", random },
+        { "sorted", sorted },
+        { "reverse_sorted", reverse_sorted },
+        { "few_unique", few_unique },
+        { "all_equal_first", all_equal_first },
+        { "organ_pipe", organ_pipe },
+        { "sawtooth", sawtooth },
+        { "zipfian", zipfian }
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_BENCH_DISTRIBUTIONS_H_
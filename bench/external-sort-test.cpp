@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <tight_pair.h>
+#include <tight_pair/external_sort.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+using sorter_t = cruft::external_sorter<std::uint32_t, std::uint32_t>;
+
+// Consumes the output without storing it
+struct checking_iterator
+{
+    std::uint64_t* checksum;
+    pair_t* previous;
+    bool* sorted;
+
+    auto operator*() -> checking_iterator& { return *this; }
+    auto operator++() -> checking_iterator& { return *this; }
+    auto operator=(pair_t const& value) -> checking_iterator&
+    {
+        using cruft::get;
+        *sorted &= not(value < *previous);
+        *previous = value;
+        *checksum += get<0>(value) ^ get<1>(value);
+        return *this;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+    bool all_sorted = true;
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto pairs = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+
+            // The temporary files are written in the current directory,
+            // a memory budget of an eighth of the data forms 8 runs
+            cruft::external_sort_options options;
+            options.memory_budget = std::max<std::size_t>(size * sizeof(pair_t) / 8, 1024);
+
+            std::optional<sorter_t> sorter;
+            std::uint64_t checksum = 0;
+            pair_t previous;
+            bool sorted = true;
+            auto fill = [&] {
+                sorter.reset();
+                sorter.emplace(options);
+                std::copy(pairs.begin(), pairs.end(), sorter->sink());
+            };
+            auto finish = [&] {
+                previous = pair_t(0u, 0u);
+                sorter->finish(checking_iterator{&checksum, &previous, &sorted});
+            };
+
+            runner.run({ "cruft", "uint32", distribution.name, "run_formation", size },
+                       [&] { sorter.reset(); sorter.emplace(options); },
+                       [&] { std::copy(pairs.begin(), pairs.end(), sorter->sink()); });
+            runner.run({ "cruft", "uint32", distribution.name, "merge", size }, fill, finish);
+            runner.run({ "cruft", "uint32", distribution.name, "sort", size },
+                       [&] { sorter.reset(); },
+                       [&] { fill(); finish(); });
+            sorter.reset();
+
+            std::cerr << "checksum: " << checksum << '\n';
+            all_sorted &= sorted;
+        }
+    }
+    return all_sorted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
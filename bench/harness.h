@@ -0,0 +1,528 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_BENCH_HARNESS_H_
+#define CRUFT_TIGHT_PAIR_BENCH_HARNESS_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////
+// Minimal benchmark harness without external dependencies:
+// options parsing, timing with the time-stamp counter when
+// available, hardware performance counters on Linux, and
+// machine-readable output
+
+namespace bench
+{
+    ////////////////////////////////////////////////////////////
+    // Counter used for timings: cycles of the time-stamp counter
+    // on x86, nanoseconds of a steady clock elsewhere
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    constexpr char const* counter_unit = "cycles";
+
+    inline auto read_counter() noexcept
+        -> std::uint64_t
+    {
+        return __rdtsc();
+    }
+#else
+    constexpr char const* counter_unit = "ns";
+
+    inline auto read_counter() noexcept
+        -> std::uint64_t
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+#endif
+
+    ////////////////////////////////////////////////////////////
+    // Command line options
+
+    enum class output_format
+    {
+        csv,
+        json
+    };
+
+    struct options
+    {
+        std::vector<std::size_t> sizes;
+        std::chrono::milliseconds budget{1000};
+        output_format format = output_format::csv;
+        std::string filter;
+        std::uint64_t seed = 45518;
+        bool perf = true;
+    };
+
+    inline auto usage(char const* program)
+        -> void
+    {
+        std::cerr << "usage: " << program << " [options]\n"
+                  << "  --min-size=E    smallest collection size, 10^E elements (default 2)\n"
+                  << "  --max-size=E    biggest collection size, 10^E elements (default 6)\n"
+                  << "  --budget-ms=N   time spent measuring each configuration (default 1000)\n"
+                  << "  --format=F      csv or json (default csv)\n"
+                  << "  --filter=S      only run the configurations whose name contains S\n"
+                  << "  --seed=N        seed of the generated inputs (default 45518)\n"
+                  << "  --no-perf       don't read the hardware performance counters\n";
+    }
+
+    inline auto parse_options(int argc, char* argv[])
+        -> options
+    {
+        options res;
+        int min_exponent = 2;
+        int max_exponent = 6;
+
+        for (int i = 1 ; i < argc ; ++i) {
+            std::string arg = argv[i];
+            auto eq = arg.find('=');
+            auto name = arg.substr(0, eq);
+            auto value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+            if (name == "--min-size") {
+                min_exponent = std::atoi(value.c_str());
+            } else if (name == "--max-size") {
+                max_exponent = std::atoi(value.c_str());
+            } else if (name == "--budget-ms") {
+                res.budget = std::chrono::milliseconds(std::atol(value.c_str()));
+            } else if (name == "--format" && (value == "csv" || value == "json")) {
+                res.format = value == "csv" ? output_format::csv : output_format::json;
+            } else if (name == "--filter") {
+                res.filter = value;
+            } else if (name == "--seed") {
+                res.seed = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (name == "--no-perf") {
+                res.perf = false;
+            } else {
+                usage(argv[0]);
+                std::exit(name == "--help" ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+        }
+
+        std::size_t size = 1;
+        for (int exponent = 0 ; exponent <= max_exponent ; ++exponent) {
+            if (exponent >= min_exponent) {
+                res.sizes.push_back(size);
+            }
+            size *= 10;
+        }
+        return res;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Hardware performance counters read with perf_event_open,
+    // counting the current thread in user space only. Counters
+    // that can't be opened, for example because of the value of
+    // /proc/sys/kernel/perf_event_paranoid or in a virtual machine
+    // without a PMU, are silently left out, and there are none at
+    // all on other platforms
+
+    class perf_counters
+    {
+        public:
+
+            explicit perf_counters(bool enabled)
+            {
+#if defined(__linux__)
+                if (not enabled) {
+                    return;
+                }
+
+                struct event
+                {
+                    char const* name;
+                    std::uint32_t type;
+                    std::uint64_t config;
+                };
+
+                constexpr std::uint64_t l1d_read_miss =
+                    PERF_COUNT_HW_CACHE_L1D |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+                event const events[] = {
+                    { "core_cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                    { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+                    { "l1d_misses", PERF_TYPE_HW_CACHE, l1d_read_miss },
+                    { "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                };
+
+                for (auto const& ev: events) {
+                    perf_event_attr attr{};
+                    attr.size = sizeof(attr);
+                    attr.type = ev.type;
+                    attr.config = ev.config;
+                    attr.disabled = 1;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+                    if (fd != -1) {
+                        fds_.push_back(fd);
+                        names_.push_back(ev.name);
+                    }
+                }
+#else
+                (void) enabled;
+#endif
+            }
+
+            perf_counters(perf_counters const&) = delete;
+            perf_counters& operator=(perf_counters const&) = delete;
+
+            ~perf_counters()
+            {
+#if defined(__linux__)
+                for (int fd: fds_) {
+                    close(fd);
+                }
+#endif
+            }
+
+            auto names() const
+                -> std::vector<char const*> const&
+            {
+                return names_;
+            }
+
+            auto start()
+                -> void
+            {
+#if defined(__linux__)
+                for (int fd: fds_) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+#endif
+            }
+
+            // Values of the counters since the last call to start
+            auto stop(std::vector<std::uint64_t>& values)
+                -> void
+            {
+                values.assign(fds_.size(), 0);
+#if defined(__linux__)
+                for (int fd: fds_) {
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                }
+                for (std::size_t i = 0 ; i < fds_.size() ; ++i) {
+                    if (read(fds_[i], &values[i], sizeof(values[i])) != sizeof(values[i])) {
+                        values[i] = 0;
+                    }
+                }
+#endif
+            }
+
+        private:
+
+            std::vector<int> fds_;
+            std::vector<char const*> names_;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Summary of the samples of a metric: median and median
+    // absolute deviation, both robust to the occasional outlier
+    // caused by an interrupt or a migration
+
+    struct metric
+    {
+        std::string name;
+        double median;
+        double mad;
+    };
+
+    inline auto summarize(std::string name, std::vector<double> samples)
+        -> metric
+    {
+        auto median_of = [](std::vector<double>& values) {
+            auto middle = values.begin() + values.size() / 2;
+            std::nth_element(values.begin(), middle, values.end());
+            return *middle;
+        };
+        auto median = median_of(samples);
+        for (auto& sample: samples) {
+            sample = sample > median ? sample - median : median - sample;
+        }
+        return { std::move(name), median, median_of(samples) };
+    }
+
+    struct measurement
+    {
+        std::size_t runs;
+        std::vector<metric> metrics;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Measurement: runs setup then the measured function until
+    // the time budget is spent, at least once. Every metric is
+    // given per element, except the number of instructions per
+    // core cycle (ipc)
+
+    template<typename Setup, typename Function>
+    auto measure(std::size_t size, std::chrono::milliseconds budget, perf_counters& counters,
+                 Setup setup, Function func)
+        -> measurement
+    {
+        auto const& names = counters.names();
+        std::vector<double> times;
+        std::vector<std::vector<double>> samples(names.size());
+        std::vector<double> ipc;
+        std::vector<std::uint64_t> values;
+
+        auto index_of = [&](std::string const& name) {
+            return static_cast<std::size_t>(
+                std::find(names.begin(), names.end(), name) - names.begin()
+            );
+        };
+        auto cycles_index = index_of("core_cycles");
+        auto instructions_index = index_of("instructions");
+        bool has_ipc = cycles_index < names.size() && instructions_index < names.size();
+
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        do {
+            setup();
+            counters.start();
+            auto start = read_counter();
+            func();
+            auto end = read_counter();
+            counters.stop(values);
+
+            times.push_back(static_cast<double>(end - start) / static_cast<double>(size));
+            for (std::size_t i = 0 ; i < values.size() ; ++i) {
+                samples[i].push_back(static_cast<double>(values[i]) / static_cast<double>(size));
+            }
+            if (has_ipc && values[cycles_index] != 0) {
+                ipc.push_back(static_cast<double>(values[instructions_index]) /
+                              static_cast<double>(values[cycles_index]));
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        measurement res{ times.size(), {} };
+        res.metrics.push_back(summarize(counter_unit, std::move(times)));
+        for (std::size_t i = 0 ; i < names.size() ; ++i) {
+            res.metrics.push_back(summarize(names[i], std::move(samples[i])));
+        }
+        if (not ipc.empty()) {
+            res.metrics.push_back(summarize("ipc", std::move(ipc)));
+        }
+        return res;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Results output, one record per measured configuration and
+    // metric in CSV, one object per configuration in JSON
+
+    struct result
+    {
+        std::string pair;
+        std::string type;
+        std::string distribution;
+        std::string algorithm;
+        std::size_t size;
+        measurement values;
+    };
+
+    class result_writer
+    {
+        public:
+
+            result_writer(std::ostream& out, output_format format):
+                out_(out),
+                format_(format)
+            {
+                if (format_ == output_format::csv) {
+                    out_ << "pair,type,distribution,algorithm,size,runs,metric,median,mad\n";
+                } else {
+                    out_ << "[";
+                }
+            }
+
+            result_writer(result_writer const&) = delete;
+            result_writer& operator=(result_writer const&) = delete;
+
+            ~result_writer()
+            {
+                if (format_ == output_format::json) {
+                    out_ << "\n]\n";
+                }
+            }
+
+            auto write(result const& res)
+                -> void
+            {
+                if (format_ == output_format::csv) {
+                    for (auto const& m: res.values.metrics) {
+                        out_ << res.pair << ',' << res.type << ',' << res.distribution << ','
+                             << res.algorithm << ',' << res.size << ',' << res.values.runs << ','
+                             << m.name << ',' << m.median << ',' << m.mad << '\n';
+                    }
+                } else {
+                    out_ << (first_ ? "\n" : ",\n")
+                         << "  { \"pair\": \"" << res.pair << "\", \"type\": \"" << res.type
+                         << "\", \"distribution\": \"" << res.distribution
+                         << "\", \"algorithm\": \"" << res.algorithm << "\", \"size\": " << res.size
+                         << ", \"runs\": " << res.values.runs << ", \"metrics\": {";
+                    bool first_metric = true;
+                    for (auto const& m: res.values.metrics) {
+                        out_ << (first_metric ? " \"" : ", \"") << m.name << "\": { \"median\": "
+                             << m.median << ", \"mad\": " << m.mad << " }";
+                        first_metric = false;
+                    }
+                    out_ << " } }";
+                }
+                out_.flush();
+                first_ = false;
+            }
+
+        private:
+
+            std::ostream& out_;
+            output_format format_;
+            bool first_ = true;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Driver of a benchmark executable: parses the options, opens
+    // the performance counters and writes the measurements of the
+    // configurations selected by --filter to the standard output.
+    // The pair field tells where the measured code comes from:
+    // std, cruft, or baseline for references written in the
+    // benchmark itself
+
+    struct configuration
+    {
+        std::string pair;
+        std::string type;
+        std::string distribution;
+        std::string algorithm;
+        std::size_t size;
+    };
+
+    class runner
+    {
+        public:
+
+            runner(int argc, char* argv[]):
+                options_(parse_options(argc, argv)),
+                counters_(options_.perf),
+                no_counters_(false),
+                writer_(std::cout, options_.format)
+            {
+                if (options_.perf && counters_.names().empty()) {
+                    std::cerr << "hardware performance counters unavailable, only measuring "
+                              << counter_unit << '\n';
+                }
+            }
+
+            runner(runner const&) = delete;
+            runner& operator=(runner const&) = delete;
+
+            auto opts() const
+                -> options const&
+            {
+                return options_;
+            }
+
+            // The filter applies to type/distribution/algorithm, so
+            // that all the implementations of an operation are kept
+            auto selected(configuration const& config) const
+                -> bool
+            {
+                auto name = config.type + '/' + config.distribution + '/' + config.algorithm;
+                return name.find(options_.filter) != std::string::npos;
+            }
+
+            template<typename Setup, typename Function>
+            auto measure(configuration const& config, Setup setup, Function func)
+                -> measurement
+            {
+                log(config);
+                return bench::measure(config.size, options_.budget, counters_, setup, func);
+            }
+
+            // The counters only see the calling thread, they are left
+            // out of the configurations running several threads
+            template<typename Setup, typename Function>
+            auto measure_threads(configuration const& config, Setup setup, Function func)
+                -> measurement
+            {
+                log(config);
+                return bench::measure(config.size, options_.budget, no_counters_, setup, func);
+            }
+
+            auto write(configuration const& config, measurement values)
+                -> void
+            {
+                writer_.write({ config.pair, config.type, config.distribution,
+                                config.algorithm, config.size, std::move(values) });
+            }
+
+            // Measure and write a configuration when it is selected
+            template<typename Setup, typename Function>
+            auto run(configuration const& config, Setup setup, Function func)
+                -> void
+            {
+                if (selected(config)) {
+                    write(config, measure(config, setup, func));
+                }
+            }
+
+            template<typename Setup, typename Function>
+            auto run_threads(configuration const& config, Setup setup, Function func)
+                -> void
+            {
+                if (selected(config)) {
+                    write(config, measure_threads(config, setup, func));
+                }
+            }
+
+        private:
+
+            static auto log(configuration const& config)
+                -> void
+            {
+                std::cerr << config.pair << ' ' << config.type << '/' << config.distribution << '/'
+                          << config.algorithm << ' ' << config.size << '\n';
+            }
+
+            options options_;
+            perf_counters counters_;
+            perf_counters no_counters_;
+            result_writer writer_;
+    };
+
+    // For the configurations without setup
+    inline auto no_setup() noexcept
+        -> void
+    {}
+}
+
+#endif // CRUFT_TIGHT_PAIR_BENCH_HARNESS_H_
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/hash_table.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+// Both containers use the same hash function
+struct std_pair_hash
+{
+    auto operator()(pair_t const& value) const noexcept
+        -> std::size_t
+    {
+        return cruft::pair_hash{}(value);
+    }
+};
+
+template<typename Set, typename Insert, typename Contains>
+auto bench_set(bench::runner& runner, char const* pair, char const* distribution,
+               std::vector<pair_t> const& keys, std::vector<pair_t> const& hits,
+               std::vector<pair_t> const& missing, Insert insert, Contains contains)
+    -> void
+{
+    auto size = keys.size();
+    std::size_t found = 0;
+    Set set;
+    auto fill = [&] {
+        for (auto const& key: keys) {
+            insert(set, key);
+        }
+    };
+
+    runner.run({ pair, "uint32", distribution, "insert", size },
+               [&] { set = Set(); }, fill);
+    set = Set();
+    fill();
+    runner.run({ pair, "uint32", distribution, "lookup_hit", size }, bench::no_setup, [&] {
+        for (auto const& key: hits) {
+            found += contains(set, key);
+        }
+    });
+    runner.run({ pair, "uint32", distribution, "lookup_miss", size }, bench::no_setup, [&] {
+        for (auto const& key: missing) {
+            found += contains(set, key);
+        }
+    });
+    std::cerr << "found: " << found << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            // Keys with an odd second member are never inserted
+            auto raw = distribution.generate(size, opts.seed);
+            std::vector<pair_t> keys, missing;
+            for (auto const& value: raw.values) {
+                keys.emplace_back(std::uint32_t(value.first), std::uint32_t(2 * value.second));
+                missing.emplace_back(std::uint32_t(value.first), std::uint32_t(2 * value.second + 1));
+            }
+            // Looking keys up in insertion order would favour node-based
+            // containers whose nodes are allocated in that order
+            auto hits = keys;
+            std::shuffle(hits.begin(), hits.end(), std::mt19937_64(opts.seed));
+
+            bench_set<std::unordered_set<pair_t, std_pair_hash>>(
+                runner, "std", distribution.name, keys, hits, missing,
+                [](auto& set, pair_t key) { set.insert(key); },
+                [](auto const& set, pair_t key) { return set.count(key); }
+            );
+            bench_set<cruft::pair_hash_set<std::uint32_t, std::uint32_t>>(
+                runner, "cruft", distribution.name, keys, hits, missing,
+                [](auto& set, pair_t key) { set.insert(key); },
+                [](auto const& set, pair_t key) { return set.contains(key); }
+            );
+        }
+    }
+}
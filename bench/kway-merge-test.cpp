@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/kway_merge.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+// Reference merge: heap of (value, stream index) in std::priority_queue
+auto priority_queue_merge(std::vector<std::vector<pair_t>> const& ranges, pair_t* out)
+    -> pair_t*
+{
+    using entry_t = cruft::tight_pair<pair_t, std::size_t>;
+    auto compare = [](entry_t const& lhs, entry_t const& rhs) { return rhs < lhs; };
+    std::priority_queue<entry_t, std::vector<entry_t>, decltype(compare)> queue(compare);
+
+    std::vector<std::size_t> positions(ranges.size(), 0);
+    for (std::size_t i = 0 ; i < ranges.size() ; ++i) {
+        if (not ranges[i].empty()) {
+            queue.emplace(ranges[i][0], i);
+        }
+    }
+    while (not queue.empty()) {
+        using cruft::get;
+        auto top = queue.top();
+        queue.pop();
+        *out++ = get<0>(top);
+        auto source = get<1>(top);
+        if (++positions[source] < ranges[source].size()) {
+            queue.emplace(ranges[source][positions[source]], source);
+        }
+    }
+    return out;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto pairs = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+            for (std::size_t ways = 2 ; ways <= 1024 && ways <= size ; ways *= 2) {
+                std::vector<std::vector<pair_t>> ranges(ways);
+                for (std::size_t i = 0 ; i < size ; ++i) {
+                    ranges[i % ways].push_back(pairs[i]);
+                }
+                for (auto& range: ranges) {
+                    std::sort(range.begin(), range.end());
+                }
+                std::vector<pair_t> output(size);
+
+                auto suffix = '-' + std::to_string(ways) + "ways";
+                runner.run({ "cruft", "uint32", distribution.name, "kway_merge" + suffix, size },
+                           bench::no_setup, [&] { cruft::kway_merge(ranges, output.data()); });
+                runner.run({ "baseline", "uint32", distribution.name, "priority_queue" + suffix, size },
+                           bench::no_setup, [&] { priority_queue_merge(ranges, output.data()); });
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/mapped_pair_table.h>
+#include <tight_pair/serialization.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+    const char* path = "tight_pair-mapped-table-bench.bin";
+
+    for (auto size: opts.sizes) {
+        auto pairs = bench::make_pairs<pair_t>(bench::sorted(size, opts.seed));
+        {
+            std::ofstream file(path, std::ios::binary);
+            cruft::write_pair_table(file, pairs.begin(), pairs.end());
+        }
+
+        // As many lookups as pairs in the table
+        std::mt19937_64 engine(opts.seed);
+        std::vector<pair_t> queries;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            queries.push_back(pairs[engine() % size]);
+        }
+
+        // Startup: read and decode the whole file
+        std::vector<pair_t> decoded;
+        auto decode = [&] {
+            std::ifstream file(path, std::ios::binary);
+            std::vector<unsigned char> bytes(std::istreambuf_iterator<char>(file), {});
+            decoded.resize(bytes.size() / 8);
+            for (std::size_t i = 0 ; i < decoded.size() ; ++i) {
+                decoded[i] = cruft::decode_pair<std::uint32_t, std::uint32_t>(bytes.data() + 8 * i);
+            }
+        };
+        runner.run({ "baseline", "uint32", "sorted", "startup", size }, bench::no_setup, decode);
+
+        // Startup: map the file
+        std::optional<cruft::mapped_pair_table<std::uint32_t, std::uint32_t>> table;
+        runner.run({ "cruft", "uint32", "sorted", "startup", size },
+                   [&] { table.reset(); },
+                   [&] { table.emplace(path); });
+
+        std::size_t found = 0;
+        decode();
+        runner.run({ "baseline", "uint32", "sorted", "lookup", size }, bench::no_setup, [&] {
+            for (auto const& query: queries) {
+                found += std::binary_search(decoded.begin(), decoded.end(), query);
+            }
+        });
+        table.emplace(path);
+        runner.run({ "cruft", "uint32", "sorted", "lookup", size }, bench::no_setup, [&] {
+            for (auto const& query: queries) {
+                found += table->contains(query);
+            }
+        });
+        std::cerr << "found: " << found << '\n';
+
+        table.reset();
+        std::remove(path);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/merge.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+auto make_sorted_pairs(bench::named_distribution const& distribution, std::size_t size, std::uint64_t seed)
+    -> std::vector<pair_t>
+{
+    auto res = bench::make_pairs<pair_t>(distribution.generate(size, seed));
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto big_size: opts.sizes) {
+            // From balanced inputs to very skewed ones
+            for (std::size_t ratio: { 1, 10, 100, 1000 }) {
+                auto small_size = big_size / ratio;
+                if (small_size == 0) {
+                    break;
+                }
+                auto lhs = make_sorted_pairs(distribution, big_size, opts.seed);
+                auto rhs = make_sorted_pairs(distribution, small_size, opts.seed + 1);
+                std::vector<pair_t> output(lhs.size() + rhs.size());
+                auto total = lhs.size() + rhs.size();
+                std::size_t checksum = 0;
+
+                auto suffix = "-1:" + std::to_string(ratio);
+                auto run = [&](char const* pair, char const* algorithm, auto func) {
+                    runner.run({ pair, "uint32", distribution.name, algorithm + suffix, total },
+                               bench::no_setup, func);
+                };
+
+                run("std", "merge", [&] {
+                    std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), output.data());
+                });
+                run("cruft", "merge", [&] {
+                    cruft::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), output.data());
+                });
+                run("std", "set_intersection", [&] {
+                    checksum += std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                      output.data()) - output.data();
+                });
+                run("cruft", "set_intersection", [&] {
+                    checksum += cruft::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                        output.data()) - output.data();
+                });
+                run("std", "set_difference", [&] {
+                    checksum += std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                    output.data()) - output.data();
+                });
+                run("cruft", "set_difference", [&] {
+                    checksum += cruft::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                      output.data()) - output.data();
+                });
+
+                std::size_t matches = 0;
+                run("baseline", "merge_join_on_first", [&] {
+                    // Reference: std::equal_range-free lockstep join with branches
+                    auto first1 = lhs.begin();
+                    auto first2 = rhs.begin();
+                    while (first1 != lhs.end() && first2 != rhs.end()) {
+                        using cruft::get;
+                        if (get<0>(*first1) < get<0>(*first2)) { ++first1; continue; }
+                        if (get<0>(*first2) < get<0>(*first1)) { ++first2; continue; }
+                        auto end1 = first1;
+                        while (end1 != lhs.end() && get<0>(*end1) == get<0>(*first1)) ++end1;
+                        auto end2 = first2;
+                        while (end2 != rhs.end() && get<0>(*end2) == get<0>(*first2)) ++end2;
+                        matches += (end1 - first1) * (end2 - first2);
+                        first1 = end1;
+                        first2 = end2;
+                    }
+                });
+                run("cruft", "merge_join_on_first", [&] {
+                    cruft::merge_join_on_first(lhs, rhs, [&](pair_t const&, pair_t const&) { ++matches; });
+                });
+                std::cerr << "checksum: " << checksum + matches << '\n';
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/morton.h>
+#include "distributions.h"
+#include "harness.h"
+
+using point_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+// Average number of contiguous runs of the sorted array needed to
+// cover the points of a square box a 64th of the side of the grid:
+// the fewer the better
+auto box_query_runs(std::vector<point_t> const& sorted_points, std::uint32_t grid_size)
+    -> double
+{
+    using cruft::get;
+
+    auto box_size = std::max<std::uint32_t>(grid_size / 64, 1);
+    std::mt19937_64 engine(510);
+    std::uniform_int_distribution<std::uint32_t> dist(0, grid_size - box_size);
+    constexpr int nb_queries = 200;
+
+    std::size_t total_runs = 0;
+    for (int query = 0 ; query < nb_queries ; ++query) {
+        auto x = dist(engine);
+        auto y = dist(engine);
+        bool in_run = false;
+        for (auto const& point: sorted_points) {
+            bool inside = get<0>(point) - x < box_size && get<1>(point) - y < box_size;
+            total_runs += inside && not in_run;
+            in_run = inside;
+        }
+    }
+    return double(total_runs) / nb_queries;
+}
+
+template<typename Sort>
+auto bench_sort(bench::runner& runner, bench::configuration const& config,
+                std::vector<point_t> const& points, std::uint32_t grid_size, Sort sort)
+    -> void
+{
+    if (not runner.selected(config)) {
+        return;
+    }
+    std::vector<point_t> sorted;
+    auto res = runner.measure(config, [&] { sorted = points; }, [&] { sort(sorted); });
+    // Box queries scan the whole array, keep them for sizes where they
+    // are still fast
+    if (points.size() <= 1'000'000) {
+        res.metrics.push_back({ "box_runs", box_query_runs(sorted, grid_size), 0.0 });
+    }
+    runner.write(config, std::move(res));
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            // Both coordinates of the points are smaller than the size
+            auto points = bench::make_pairs<point_t>(distribution.generate(size, opts.seed));
+            auto grid_size = static_cast<std::uint32_t>(size);
+
+            bench_sort(runner, { "std", "uint32", distribution.name, "sort_lexicographic", size },
+                       points, grid_size, [](auto& vec) {
+                std::sort(vec.begin(), vec.end());
+            });
+            bench_sort(runner, { "cruft", "uint32", distribution.name, "sort_morton_less", size },
+                       points, grid_size, [](auto& vec) {
+                std::sort(vec.begin(), vec.end(), cruft::morton_less{});
+            });
+            bench_sort(runner, { "cruft", "uint32", distribution.name, "sort_morton_keys", size },
+                       points, grid_size, [](auto& vec) {
+                std::vector<std::pair<std::uint64_t, point_t>> keyed;
+                keyed.reserve(vec.size());
+                for (auto const& point: vec) {
+                    keyed.emplace_back(cruft::morton_encode(point), point);
+                }
+                std::sort(keyed.begin(), keyed.end(), [](auto const& lhs, auto const& rhs) {
+                    return lhs.first < rhs.first;
+                });
+                for (std::size_t i = 0 ; i < vec.size() ; ++i) {
+                    vec[i] = keyed[i].second;
+                }
+            });
+        }
+    }
+}
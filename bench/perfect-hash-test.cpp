@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/hash_table.h>
+#include <tight_pair/perfect_hash.h>
+#include <tight_pair/sorted_table.h>
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+using entry_t = cruft::tight_pair<pair_t, std::uint32_t>;
+
+// 64 (type, version) keys: sparse message types with up to 4
+// versions each, mapped to handler indices
+constexpr auto make_entries()
+    -> std::array<entry_t, 64>
+{
+    std::array<entry_t, 64> res{};
+    for (std::uint32_t i = 0 ; i < 64 ; ++i) {
+        auto type = static_cast<std::uint16_t>(0x100 + (i / 4) * 37);
+        auto version = static_cast<std::uint16_t>(1 + (i % 4) * (1 + i / 16));
+        res[i] = entry_t(pair_t(type, version), i + 1);
+    }
+    return res;
+}
+
+constexpr auto entries = make_entries();
+constexpr auto perfect_map = cruft::make_constexpr_pair_map(entries);
+
+constexpr auto make_sorted_keys()
+    -> std::array<pair_t, 64>
+{
+    std::array<pair_t, 64> res{};
+    for (std::size_t i = 0 ; i < 64 ; ++i) {
+        res[i] = cruft::get<0>(entries[i]);
+    }
+    return res;
+}
+
+constexpr auto sorted_keys = cruft::make_sorted_table(make_sorted_keys());
+
+constexpr auto packed(std::size_t i)
+    -> std::uint32_t
+{
+    return cruft::detail::get_twice_as_big(cruft::get<0>(entries[i]));
+}
+
+// Baseline: switch on the packed key, as written by hand
+auto switch_lookup(pair_t key)
+    -> std::uint32_t
+{
+#define CASE(i) case packed(i): return cruft::get<1>(entries[i]);
+#define CASE4(i) CASE(i) CASE(i + 1) CASE(i + 2) CASE(i + 3)
+#define CASE16(i) CASE4(i) CASE4(i + 4) CASE4(i + 8) CASE4(i + 12)
+    switch (cruft::detail::get_twice_as_big(key)) {
+        CASE16(0) CASE16(16) CASE16(32) CASE16(48)
+        default: return 0;
+    }
+#undef CASE16
+#undef CASE4
+#undef CASE
+}
+
+struct std_pair_hash
+{
+    auto operator()(pair_t const& value) const noexcept
+        -> std::size_t
+    {
+        return cruft::pair_hash{}(value);
+    }
+};
+
+template<typename Function>
+auto bench_lookup(bench::runner& runner, bench::configuration const& config,
+                  std::vector<pair_t> const& queries, Function lookup)
+    -> void
+{
+    std::uint64_t checksum = 0;
+    runner.run(config, bench::no_setup, [&] {
+        for (auto const& query: queries) {
+            checksum += lookup(query);
+        }
+    });
+    std::cerr << "checksum: " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    std::unordered_map<pair_t, std::uint32_t, std_pair_hash> unordered;
+    for (auto const& entry: entries) {
+        unordered.emplace(cruft::get<0>(entry), cruft::get<1>(entry));
+    }
+
+    for (auto size: opts.sizes) {
+        // 90% of the queries hit a key, in random order
+        std::mt19937_64 engine(opts.seed);
+        std::uniform_int_distribution<std::size_t> index(0, 63);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::vector<pair_t> queries;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            if (percent(engine) < 90) {
+                queries.push_back(cruft::get<0>(entries[index(engine)]));
+            } else {
+                queries.emplace_back(static_cast<std::uint16_t>(engine()), static_cast<std::uint16_t>(engine()));
+            }
+        }
+
+        bench_lookup(runner, { "cruft", "uint16", "90%_hits", "constexpr_pair_map", size }, queries, [](pair_t key) {
+            auto entry = perfect_map.find(key);
+            return entry != nullptr ? cruft::get<1>(*entry) : 0u;
+        });
+        bench_lookup(runner, { "baseline", "uint16", "90%_hits", "switch", size }, queries, switch_lookup);
+        bench_lookup(runner, { "std", "uint16", "90%_hits", "unordered_map", size }, queries, [&](pair_t key) {
+            auto it = unordered.find(key);
+            return it != unordered.end() ? it->second : 0u;
+        });
+        bench_lookup(runner, { "cruft", "uint16", "90%_hits", "sorted_table", size }, queries, [](pair_t key) {
+            auto it = sorted_keys.find(key);
+            // Sorted keys don't keep their values, the index stands in for them
+            return it != sorted_keys.end() ? static_cast<std::uint32_t>(it - sorted_keys.begin()) : 0u;
+        });
+    }
+}
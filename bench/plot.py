@@ -1,17 +1,30 @@
 # -*- coding: utf-8 -*-
 
+# Plots the CSV output of tight_pair-benchmarks for one element
+# type, one size, one input distribution (shuffled by default)
+# and one metric (cycles by default):
+#
+#     python plot.py results.csv uint16 1000000 [distribution] [metric]
+
+import csv
 import sys
 from collections import OrderedDict
 
 import numpy
 from matplotlib import pyplot
 
-algos = OrderedDict()
+filename, pair_type, size = sys.argv[1], sys.argv[2], sys.argv[3]
+distribution = sys.argv[4] if len(sys.argv) > 4 else 'shuffled'
+metric = sys.argv[5] if len(sys.argv) > 5 else 'cycles'
 
-with open(sys.argv[1]) as fd:
-    for line in fd:
-        pair_type, dist, algo, seconds = line.split()
-        algos.setdefault(algo, {})[pair_type] = int(seconds)
+algos = OrderedDict()
+with open(filename) as fd:
+    for row in csv.DictReader(fd):
+        if row['type'] != pair_type or row['size'] != size or row['distribution'] != distribution:
+            continue
+        if row['metric'] != metric:
+            continue
+        algos.setdefault(row['algorithm'], {})[row['pair']] = float(row['median'])
 
 print(algos)
 
@@ -28,8 +41,11 @@ bars_std = ax.bar(ind, std_times, width, color='#1f77b4', edgecolor='#1f77b4')
 bars_cruft = ax.bar(ind+width, cruft_times, width, color='#ff7f0e', edgecolor='#ff7f0e')
 
 # add some text for labels, title and axes ticks
-ax.set_ylabel('Cycles per element (fewer is better)')
-ax.set_title(r'Sorting $10^6$ pairs of unsigned short')
+if metric == 'ipc':
+    ax.set_ylabel('Instructions per cycle')
+else:
+    ax.set_ylabel('{} per element (fewer is better)'.format(metric.replace('_', ' ').capitalize()))
+ax.set_title('Sorting {} {} pairs of {}'.format(size, distribution, pair_type))
 ax.set_xticks(ind + width)
 ax.set_xticklabels(list(algos.keys()))
 
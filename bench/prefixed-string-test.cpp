@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/prefixed_string.h>
+#include "harness.h"
+
+auto random_string(std::mt19937_64& engine, std::size_t size, std::string_view alphabet)
+    -> std::string
+{
+    std::uniform_int_distribution<std::size_t> dist(0, alphabet.size() - 1);
+    std::string res;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        res.push_back(alphabet[dist(engine)]);
+    }
+    return res;
+}
+
+constexpr std::string_view lowercase = "abcdefghijklmnopqrstuvwxyz";
+constexpr std::string_view hexdigits = "0123456789abcdef";
+
+// Words of 3 to 12 lowercase letters
+auto words(std::mt19937_64& engine, std::size_t size)
+    -> std::vector<std::string>
+{
+    std::uniform_int_distribution<std::size_t> length(3, 12);
+    std::vector<std::string> res;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        res.push_back(random_string(engine, length(engine), lowercase));
+    }
+    return res;
+}
+
+// Tokens drawn from a vocabulary with a Zipf-like distribution,
+// many strings are equal
+auto zipf_tokens(std::mt19937_64& engine, std::size_t size)
+    -> std::vector<std::string>
+{
+    auto vocabulary = words(engine, 10'000);
+    std::vector<double> weights;
+    for (std::size_t i = 0 ; i < vocabulary.size() ; ++i) {
+        weights.push_back(1.0 / static_cast<double>(i + 1));
+    }
+    std::discrete_distribution<std::size_t> dist(weights.begin(), weights.end());
+    std::vector<std::string> res;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        res.push_back(vocabulary[dist(engine)]);
+    }
+    return res;
+}
+
+// 32 hexadecimal digits, like hashes or UUIDs
+auto hex_ids(std::mt19937_64& engine, std::size_t size)
+    -> std::vector<std::string>
+{
+    std::vector<std::string> res;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        res.push_back(random_string(engine, 32, hexdigits));
+    }
+    return res;
+}
+
+// URLs sharing a few hosts: the prefixes are almost always
+// equal, which is the worst case for prefixed strings
+auto urls(std::mt19937_64& engine, std::size_t size)
+    -> std::vector<std::string>
+{
+    std::vector<std::string> hosts = {
+        "https://www.example.com/", "https://docs.example.org/", "http://cdn.example.net/static/"
+    };
+    std::uniform_int_distribution<std::size_t> host(0, hosts.size() - 1);
+    std::uniform_int_distribution<std::size_t> length(4, 24);
+    std::vector<std::string> res;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        res.push_back(hosts[host(engine)] + random_string(engine, length(engine), lowercase));
+    }
+    return res;
+}
+
+template<typename Generator>
+auto bench_strings(bench::runner& runner, char const* name, std::size_t size, Generator generate)
+    -> void
+{
+    // Shuffle the storage so that the characters are scattered
+    // in memory relatively to the order of the pairs
+    std::mt19937_64 engine(runner.opts().seed);
+    auto strings = generate(engine, size);
+    std::vector<std::string const*> order;
+    for (auto const& str: strings) {
+        order.push_back(&str);
+    }
+    std::shuffle(order.begin(), order.end(), engine);
+
+    std::vector<cruft::tight_pair<std::string_view, std::uint32_t>> pairs;
+    for (std::size_t i = 0 ; i < size ; ++i) {
+        pairs.emplace_back(*order[i], static_cast<std::uint32_t>(i));
+    }
+    std::vector<cruft::tight_pair<cruft::prefixed_string_view, std::uint32_t>> prefixed(size);
+
+    runner.run({ "cruft", "string-uint32", name, "prefix_first", size }, bench::no_setup, [&] {
+        cruft::prefix_first(pairs.begin(), pairs.end(), prefixed.begin());
+    });
+
+    auto sorted_pairs = pairs;
+    runner.run({ "std", "string-uint32", name, "sort", size },
+               [&] { sorted_pairs = pairs; },
+               [&] { std::sort(sorted_pairs.begin(), sorted_pairs.end()); });
+    cruft::prefix_first(pairs.begin(), pairs.end(), prefixed.begin());
+    auto sorted_prefixed = prefixed;
+    runner.run({ "cruft", "string-uint32", name, "sort", size },
+               [&] { sorted_prefixed = prefixed; },
+               [&] { std::sort(sorted_prefixed.begin(), sorted_prefixed.end()); });
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    for (auto size: runner.opts().sizes) {
+        bench_strings(runner, "words", size, words);
+        bench_strings(runner, "zipf_tokens", size, zipf_tokens);
+        bench_strings(runner, "hex_ids", size, hex_ids);
+        bench_strings(runner, "urls", size, urls);
+    }
+}
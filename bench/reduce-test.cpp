@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/reduce.h>
+#include "harness.h"
+
+// Reference: straightforward loop checking the key of every element
+template<typename T>
+auto naive_reduce_by_first(T const* first, T const* last, T* out)
+    -> T*
+{
+    using cruft::get;
+    while (first != last) {
+        auto key = get<0>(*first);
+        auto acc = get<1>(*first);
+        for (++first ; first != last && get<0>(*first) == key ; ++first) {
+            acc += get<1>(*first);
+        }
+        *out++ = T(key, acc);
+    }
+    return out;
+}
+
+template<typename Value>
+auto bench_type(char const* type_name, bench::runner& runner)
+    -> void
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, Value>;
+
+    for (auto size: runner.opts().sizes) {
+        for (std::size_t run_length: { 1, 8, 64, 1024, 65536 }) {
+            if (run_length > size) {
+                break;
+            }
+            std::vector<pair_t> pairs;
+            pairs.reserve(size);
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                pairs.emplace_back(std::uint32_t(i / run_length), Value(i % 7));
+            }
+            std::vector<pair_t> output(size);
+
+            auto distribution = "runs_of_" + std::to_string(run_length);
+            runner.run({ "baseline", type_name, distribution, "reduce_by_first", size }, bench::no_setup, [&] {
+                naive_reduce_by_first(pairs.data(), pairs.data() + size, output.data());
+            });
+            runner.run({ "cruft", type_name, distribution, "reduce_by_first", size }, bench::no_setup, [&] {
+                cruft::reduce_by_first(pairs.data(), pairs.data() + size, output.data());
+            });
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    bench_type<std::uint32_t>("uint32", runner);
+    bench_type<float>("uint32-float", runner);
+}
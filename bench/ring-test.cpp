@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/ring.h>
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+constexpr std::size_t capacity = 1024;
+
+// Baseline: bounded queue protected by a mutex
+class locked_queue
+{
+    public:
+
+        explicit locked_queue(std::size_t capacity):
+            capacity_(capacity)
+        {}
+
+        template<typename Iterator>
+        auto push_n(Iterator first, std::size_t count)
+            -> std::size_t
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count = std::min(count, capacity_ - queue_.size());
+            queue_.insert(queue_.end(), first, first + count);
+            return count;
+        }
+
+        template<typename Iterator>
+        auto pop_n(Iterator out, std::size_t count)
+            -> std::size_t
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count = std::min(count, queue_.size());
+            std::copy(queue_.begin(), queue_.begin() + count, out);
+            queue_.erase(queue_.begin(), queue_.begin() + count);
+            return count;
+        }
+
+    private:
+
+        std::size_t capacity_;
+        std::mutex mutex_;
+        std::deque<pair_t> queue_;
+};
+
+// Every producer sends size / nb_producers messages by batches
+// of batch_size to the consumers
+template<typename Queue>
+auto bench_queue(bench::runner& runner, bench::configuration const& config,
+                 std::size_t nb_producers, std::size_t nb_consumers, std::size_t batch_size)
+    -> void
+{
+    auto per_producer = config.size / nb_producers;
+    auto total = per_producer * nb_producers;
+    std::optional<Queue> queue;
+    std::atomic<std::uint64_t> checksum(0);
+
+    runner.run_threads(
+        config,
+        [&] {
+            queue.reset();
+            queue.emplace(capacity);
+        },
+        [&] {
+            std::atomic<std::size_t> received(0);
+            std::vector<std::thread> threads;
+            for (std::size_t p = 0 ; p < nb_producers ; ++p) {
+                threads.emplace_back([&, p] {
+                    std::vector<pair_t> batch(batch_size);
+                    for (std::size_t i = 0 ; i < per_producer ; i += batch_size) {
+                        auto count = std::min(batch_size, per_producer - i);
+                        for (std::size_t j = 0 ; j < count ; ++j) {
+                            batch[j] = pair_t(std::uint32_t(p), std::uint32_t(i + j));
+                        }
+                        std::size_t done = 0;
+                        while (done < count) {
+                            auto pushed = queue->push_n(batch.begin() + done, count - done);
+                            if (pushed == 0) {
+                                std::this_thread::yield();
+                            }
+                            done += pushed;
+                        }
+                    }
+                });
+            }
+            for (std::size_t c = 0 ; c < nb_consumers ; ++c) {
+                threads.emplace_back([&] {
+                    std::vector<pair_t> batch(batch_size);
+                    std::uint64_t sum = 0;
+                    while (received.load(std::memory_order_relaxed) < total) {
+                        auto popped = queue->pop_n(batch.begin(), batch_size);
+                        if (popped == 0) {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        for (std::size_t j = 0 ; j < popped ; ++j) {
+                            using cruft::get;
+                            sum += get<1>(batch[j]);
+                        }
+                        received += popped;
+                    }
+                    checksum += sum;
+                });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+        }
+    );
+    std::cerr << "checksum: " << checksum << '\n';
+}
+
+// Round trips of size messages bounced between two threads
+auto bench_round_trip(bench::runner& runner, std::size_t size)
+    -> void
+{
+    using ring_t = cruft::pair_ring<std::uint32_t, std::uint32_t, cruft::ring_kind::spsc>;
+    ring_t ping(64), pong(64);
+
+    runner.run_threads({ "cruft", "uint32", "1p1c-batch1", "spsc_round_trip", size }, bench::no_setup, [&] {
+        std::thread echo([&] {
+            pair_t value;
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                while (not ping.try_pop(value)) {
+                    std::this_thread::yield();
+                }
+                while (not pong.try_push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        pair_t value;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            while (not ping.try_push(pair_t(std::uint32_t(i), 0u))) {
+                std::this_thread::yield();
+            }
+            while (not pong.try_pop(value)) {
+                std::this_thread::yield();
+            }
+        }
+        echo.join();
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    // The MPMC rings are measured with at least one producer and
+    // one consumer, even on a single hardware thread
+    std::size_t hardware_threads = std::thread::hardware_concurrency();
+    std::size_t max_threads = std::max<std::size_t>(hardware_threads, 2);
+    std::cerr << "hardware threads: " << hardware_threads << '\n';
+
+    using spsc_ring_t = cruft::pair_ring<std::uint32_t, std::uint32_t, cruft::ring_kind::spsc>;
+    using mpmc_ring_t = cruft::pair_ring<std::uint32_t, std::uint32_t, cruft::ring_kind::mpmc>;
+
+    for (auto size: runner.opts().sizes) {
+        for (std::size_t batch_size: { 1, 32 }) {
+            auto batch = "-batch" + std::to_string(batch_size);
+            bench_queue<spsc_ring_t>(runner, { "cruft", "uint32", "1p1c" + batch, "spsc_pair_ring", size },
+                                     1, 1, batch_size);
+            for (std::size_t nb_threads = 1 ; 2 * nb_threads <= max_threads ; nb_threads *= 2) {
+                auto threads = std::to_string(nb_threads);
+                auto distribution = threads + 'p' + threads + 'c' + batch;
+                bench_queue<mpmc_ring_t>(runner, { "cruft", "uint32", distribution, "mpmc_pair_ring", size },
+                                         nb_threads, nb_threads, batch_size);
+                bench_queue<locked_queue>(runner, { "baseline", "uint32", distribution, "locked_queue", size },
+                                          nb_threads, nb_threads, batch_size);
+            }
+        }
+        bench_round_trip(runner, size);
+    }
+}
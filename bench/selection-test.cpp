@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/selection.h>
+#include "distributions.h"
+#include "harness.h"
+
+// (score, id) candidates
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+    std::size_t checksum = 0;
+
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto pairs = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+            auto run = [&](char const* pair, std::string const& algorithm, auto setup, auto func) {
+                runner.run({ pair, "uint32", distribution.name, algorithm, size }, setup, func);
+            };
+
+            run("std", "min_element", bench::no_setup, [&] {
+                checksum += std::min_element(pairs.begin(), pairs.end()) - pairs.begin();
+            });
+            run("cruft", "min_element", bench::no_setup, [&] {
+                checksum += cruft::min_element_packed(pairs.begin(), pairs.end()) - pairs.begin();
+            });
+            run("std", "minmax_element", bench::no_setup, [&] {
+                checksum += std::minmax_element(pairs.begin(), pairs.end()).first - pairs.begin();
+            });
+            run("cruft", "minmax_element", bench::no_setup, [&] {
+                checksum += cruft::minmax_element_packed(pairs.begin(), pairs.end()).first - pairs.begin();
+            });
+
+            // Best candidates: greatest scores first
+            std::vector<pair_t> work;
+            for (std::size_t k: { 10, 100, 500 }) {
+                if (k > size) {
+                    break;
+                }
+                std::vector<pair_t> output(k);
+                auto name = "top_" + std::to_string(k);
+                run("std", name, [&] { work = pairs; }, [&] {
+                    std::partial_sort(work.begin(), work.begin() + k, work.end(), std::greater<>{});
+                    checksum += cruft::get<1>(work[0]);
+                });
+                run("cruft", name, bench::no_setup, [&] {
+                    cruft::top_k(pairs.begin(), pairs.end(), k, output.begin(), std::greater<>{});
+                    checksum += cruft::get<1>(output[0]);
+                });
+            }
+        }
+    }
+    std::cerr << "checksum: " << checksum << '\n';
+}
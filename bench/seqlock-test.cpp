@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/seqlock.h>
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<double, std::uint64_t>;
+
+// Baseline: pair protected by a reader-writer lock
+class shared_mutex_pair
+{
+    public:
+
+        auto load() const
+            -> pair_t
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            return value_;
+        }
+
+        auto store(pair_t const& value)
+            -> void
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            value_ = value;
+        }
+
+    private:
+
+        mutable std::shared_mutex mutex_;
+        pair_t value_;
+};
+
+// Every reader loads the pair size times while a writer updates
+// it, the time per element is the time per load of all the
+// readers together
+template<typename Pair>
+auto bench_pair(bench::runner& runner, bench::configuration const& config, std::size_t nb_readers,
+                std::chrono::microseconds write_period)
+    -> void
+{
+    auto reads_per_reader = config.size / nb_readers;
+    std::atomic<std::uint64_t> checksum(0);
+
+    runner.run_threads(config, bench::no_setup, [&] {
+        Pair pair;
+        std::atomic<std::size_t> done(0);
+
+        std::thread writer([&] {
+            std::uint64_t i = 0;
+            while (done.load(std::memory_order_relaxed) < nb_readers) {
+                ++i;
+                pair.store(pair_t(double(i), i));
+                // Sleeping would delay the end of the run by up to a
+                // whole period once the readers are done
+                auto next_write = std::chrono::steady_clock::now() + write_period;
+                while (std::chrono::steady_clock::now() < next_write
+                       && done.load(std::memory_order_relaxed) < nb_readers) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        std::vector<std::thread> readers;
+        for (std::size_t r = 0 ; r < nb_readers ; ++r) {
+            readers.emplace_back([&] {
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0 ; i < reads_per_reader ; ++i) {
+                    auto value = pair.load();
+                    using cruft::get;
+                    sum += get<1>(value);
+                }
+                checksum += sum;
+                ++done;
+            });
+        }
+        for (auto& reader: readers) {
+            reader.join();
+        }
+        writer.join();
+    });
+    std::cerr << "checksum: " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    // One hardware thread is left to the writer
+    std::size_t hardware_threads = std::thread::hardware_concurrency();
+    std::size_t max_readers = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    std::chrono::microseconds write_period(100);
+    std::cerr << "hardware threads: " << hardware_threads << '\n';
+
+    for (auto size: runner.opts().sizes) {
+        for (std::size_t nb_readers = 1 ; nb_readers <= max_readers && nb_readers <= size ; nb_readers *= 2) {
+            auto distribution = std::to_string(nb_readers) + "_readers";
+            bench_pair<cruft::seqlock_tight_pair<double, std::uint64_t>>(
+                runner, { "cruft", "double-uint64", distribution, "load", size }, nb_readers, write_period
+            );
+            bench_pair<shared_mutex_pair>(
+                runner, { "std", "double-uint64", distribution, "load", size }, nb_readers, write_period
+            );
+        }
+    }
+}
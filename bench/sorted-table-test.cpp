@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/sorted_table.h>
+#include "harness.h"
+
+// Compile with -DTABLE_SIZE=N to measure how the compile time
+// grows with the size of the table sorted at compile time
+#ifndef TABLE_SIZE
+#   define TABLE_SIZE 4096
+#endif
+
+using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+constexpr std::size_t table_size = TABLE_SIZE;
+
+// Pseudo-random unsorted table generated at compile time
+constexpr auto make_values()
+    -> std::array<pair_t, table_size>
+{
+    std::array<pair_t, table_size> res{};
+    std::uint32_t state = 0x5eed;
+    for (auto& value: res) {
+        state = state * 1664525u + 1013904223u;
+        value = pair_t(static_cast<std::uint16_t>(state >> 16), static_cast<std::uint16_t>(state));
+    }
+    return res;
+}
+
+constexpr auto values = make_values();
+constexpr auto table = cruft::make_sorted_table(values);
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+    auto type = "uint16-" + std::to_string(table_size) + "entries";
+
+    // Baseline: what the program used to do at startup
+    std::vector<pair_t> sorted;
+    runner.run({ "std", type, "random", "startup", table_size }, bench::no_setup, [&] {
+        sorted.assign(values.begin(), values.end());
+        std::sort(sorted.begin(), sorted.end());
+    });
+    sorted.assign(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    for (auto size: opts.sizes) {
+        std::mt19937_64 engine(opts.seed);
+        std::uniform_int_distribution<std::uint16_t> dist;
+        std::vector<pair_t> needles;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            needles.emplace_back(dist(engine), dist(engine));
+        }
+
+        std::size_t found = 0;
+        runner.run({ "cruft", type, "random", "contains", size }, bench::no_setup, [&] {
+            for (auto const& needle: needles) {
+                found += table.contains(needle);
+            }
+        });
+        runner.run({ "std", type, "random", "contains", size }, bench::no_setup, [&] {
+            for (auto const& needle: needles) {
+                found += std::binary_search(sorted.begin(), sorted.end(), needle);
+            }
+        });
+        std::cerr << "found: " << found << '\n';
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <tight_pair.h>
+#include <tight_pair/unique.h>
+#include "distributions.h"
+#include "harness.h"
+
+using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    auto const& opts = runner.opts();
+
+    // From mostly distinct elements (random) to mostly duplicates
+    // (few_unique)
+    for (auto const& distribution: bench::distributions) {
+        for (auto size: opts.sizes) {
+            auto input = bench::make_pairs<pair_t>(distribution.generate(size, opts.seed));
+            std::sort(input.begin(), input.end());
+            std::vector<pair_t> work(size);
+            std::size_t checksum = 0;
+
+            // Every run deduplicates a fresh copy of the input
+            auto copy_input = [&] { std::copy(input.begin(), input.end(), work.begin()); };
+            runner.run({ "std", "uint32", distribution.name, "unique", size }, copy_input, [&] {
+                checksum += std::unique(work.begin(), work.end()) - work.begin();
+            });
+            runner.run({ "cruft", "uint32", distribution.name, "unique", size }, copy_input, [&] {
+                checksum += cruft::unique_packed(work.begin(), work.end()).duplicates;
+            });
+            std::cerr << "checksum: " << checksum << '\n';
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tight_pair.h>
+#include "harness.h"
+
+// Forwards to another resource and counts the allocations
+class counting_resource:
+    public std::pmr::memory_resource
+{
+    public:
+
+        explicit counting_resource(std::pmr::memory_resource* upstream):
+            upstream_(upstream)
+        {}
+
+        std::size_t nb_allocations = 0;
+
+    private:
+
+        auto do_allocate(std::size_t bytes, std::size_t alignment)
+            -> void* override
+        {
+            ++nb_allocations;
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        auto do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+            -> void override
+        {
+            upstream_->deallocate(ptr, bytes, alignment);
+        }
+
+        auto do_is_equal(std::pmr::memory_resource const& other) const noexcept
+            -> bool override
+        {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream_;
+};
+
+// Baseline: pair that doesn't take part in uses-allocator construction,
+// which is how tight_pair used to behave in allocator-aware containers
+struct unaware_pair
+{
+    template<typename... Args>
+    unaware_pair(Args&&... args):
+        pair(std::forward<Args>(args)...)
+    {}
+
+    cruft::tight_pair<std::pmr::string, int> pair;
+};
+
+// Fills a pmr vector of pairs backed by an arena, also reports
+// the number of allocations per element that escaped the arena
+// to the default resource
+template<typename Pair>
+auto bench_pair(bench::runner& runner, bench::configuration const& config)
+    -> void
+{
+    if (not runner.selected(config)) {
+        return;
+    }
+
+    // Long enough to not fit in the small string buffer
+    std::string key = "a string long enough to need an allocation";
+
+    counting_resource heap(std::pmr::new_delete_resource());
+    auto old_default = std::pmr::set_default_resource(&heap);
+    auto res = runner.measure(config, [&] { heap.nb_allocations = 0; }, [&] {
+        std::pmr::monotonic_buffer_resource arena(std::pmr::new_delete_resource());
+        std::pmr::vector<Pair> pairs(&arena);
+        pairs.reserve(config.size);
+        for (std::size_t j = 0 ; j < config.size ; ++j) {
+            pairs.emplace_back(key, static_cast<int>(j));
+        }
+    });
+    std::pmr::set_default_resource(old_default);
+
+    res.metrics.push_back({ "default_allocations",
+                            static_cast<double>(heap.nb_allocations) / static_cast<double>(config.size), 0.0 });
+    runner.write(config, std::move(res));
+}
+
+int main(int argc, char* argv[])
+{
+    bench::runner runner(argc, argv);
+    for (auto size: runner.opts().sizes) {
+        bench_pair<cruft::tight_pair<std::pmr::string, int>>(
+            runner, { "cruft", "string-int", "constant", "emplace_back", size }
+        );
+        bench_pair<std::pair<std::pmr::string, int>>(
+            runner, { "std", "string-int", "constant", "emplace_back", size }
+        );
+        bench_pair<unaware_pair>(
+            runner, { "baseline", "string-int", "constant", "emplace_back", size }
+        );
+    }
+}
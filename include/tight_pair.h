@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -30,6 +31,18 @@
 #   endif
 #endif
 
+#ifndef CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS
+#   if defined(__has_cpp_attribute) && __cplusplus > 201703L && !defined(_MSC_VER)
+#       if __has_cpp_attribute(no_unique_address) >= 201803L
+#           define CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS 1
+#       else
+#           define CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS 0
+#       endif
+#   else
+#       define CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS 0
+#   endif
+#endif
+
 namespace cruft
 {
     ////////////////////////////////////////////////////////////
@@ -94,6 +107,16 @@ namespace std
 #ifdef __clang__
 #   pragma clang diagnostic pop
 #endif
+
+    ////////////////////////////////////////////////////////////
+    // Opt into uses-allocator construction like std::tuple, so
+    // that allocator-aware containers pass their allocator down
+    // to the members of the pair
+
+    template<typename T1, typename T2, typename Alloc>
+    struct uses_allocator<cruft::tight_pair<T1, T2>, Alloc>:
+        std::true_type
+    {};
 }
 
 namespace cruft
@@ -186,6 +209,25 @@ namespace cruft
         template<typename T>
         constexpr bool is_ebco_eligible_v = is_ebco_eligible<T>::value;
 
+        ////////////////////////////////////////////////////////////
+        // Whether a type can't benefit from EBCO but can still be
+        // compressed with [[no_unique_address]]: this only concerns
+        // final empty types, other empty types keep using EBCO so
+        // that the layout of the pair doesn't depend on the standard
+        // revision unless it has to
+
+        template<typename T>
+        struct is_no_unique_address_eligible:
+            std::conjunction<
+                std::bool_constant<CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS>,
+                std::is_empty<T>,
+                std::is_final<T>
+            >
+        {};
+
+        template<typename T>
+        constexpr bool is_no_unique_address_eligible_v = is_no_unique_address_eligible<T>::value;
+
         ////////////////////////////////////////////////////////////
         // Detect whether an integer has padding bits
 
@@ -303,6 +345,20 @@ namespace cruft
                 get<0>(value)) << sizeof(T) * CHAR_BIT | get<1>(value);
         }
 
+        template<typename T, typename UInt>
+        constexpr auto from_twice_as_big(UInt value) noexcept
+            -> tight_pair<T, T>
+        {
+            // Inverse of get_twice_as_big, also meant to be optimized
+            // away when the members are suitably ordered
+
+            static_assert(std::is_same_v<UInt, decltype(twice_as_big<T>())>);
+            return tight_pair<T, T>(
+                static_cast<T>(value >> sizeof(T) * CHAR_BIT),
+                static_cast<T>(value)
+            );
+        }
+
         template<typename T>
         struct can_optimize_compare:
             std::bool_constant<
@@ -314,6 +370,17 @@ namespace cruft
             >
         {};
 
+        ////////////////////////////////////////////////////////////
+        // Types whose compare member function returns a negative,
+        // zero or positive int consistent with operator<: comparing
+        // pairs whose first members are equal then only compares
+        // these members once instead of twice
+
+        template<typename T>
+        struct has_three_way_compare:
+            std::false_type
+        {};
+
         template<typename T>
         constexpr auto best_alignment()
             -> std::size_t
@@ -483,12 +550,13 @@ namespace cruft
             std::size_t N,
             typename T,
             bool = is_ebco_eligible_v<T>,
-            bool = std::is_reference_v<T>
+            bool = std::is_reference_v<T>,
+            bool = is_no_unique_address_eligible_v<T>
         >
         struct tight_pair_element;
 
         template<std::size_t N, typename T>
-        struct tight_pair_element<N, T, false, false>
+        struct tight_pair_element<N, T, false, false, false>
         {
             private:
 
@@ -567,7 +635,7 @@ namespace cruft
         };
 
         template<std::size_t N, typename T>
-        struct tight_pair_element<N, T, false, true>
+        struct tight_pair_element<N, T, false, true, false>
         {
             private:
 
@@ -657,7 +725,7 @@ namespace cruft
         };
 
         template<std::size_t N, typename T>
-        struct tight_pair_element<N, T, true, false>:
+        struct tight_pair_element<N, T, true, false, false>:
             private T
         {
             ////////////////////////////////////////////////////////////
@@ -717,6 +785,86 @@ namespace cruft
             }
         };
 
+#if CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS
+        template<std::size_t N, typename T>
+        struct tight_pair_element<N, T, false, false, true>
+        {
+            private:
+
+                // Final classes can't be inherited from, but they can
+                // still be compressed as a member with this attribute
+                [[no_unique_address]] T value;
+
+            public:
+
+                ////////////////////////////////////////////////////////////
+                // Construction
+
+                tight_pair_element(tight_pair_element const&) = default;
+                tight_pair_element(tight_pair_element&&) = default;
+
+                constexpr tight_pair_element()
+                    noexcept(std::is_nothrow_default_constructible<T>::value):
+                    value()
+                {}
+
+                template<
+                    typename U,
+                    typename = std::enable_if_t<
+                        std::is_constructible_v<T, U>
+                    >
+                >
+                constexpr explicit tight_pair_element(U&& other)
+                    noexcept(std::is_nothrow_constructible_v<T, U>):
+                    value(std::forward<U>(other))
+                {}
+
+                template<typename Tuple>
+                constexpr tight_pair_element(std::piecewise_construct_t, Tuple&& args):
+                    value(std::make_from_tuple<T>(std::forward<Tuple>(args)))
+                {}
+
+                template<typename U>
+                constexpr auto operator=(U&& other)
+                    noexcept(std::is_nothrow_assignable<T&, U>::value)
+                    -> tight_pair_element&
+                {
+                    value = std::forward<U>(other);
+                    return *this;
+                }
+
+                tight_pair_element& operator=(tight_pair_element const&) = default;
+                tight_pair_element& operator=(tight_pair_element&&) = default;
+
+                ////////////////////////////////////////////////////////////
+                // Element access
+
+                constexpr auto do_get() & noexcept
+                    -> T&
+                {
+                    return static_cast<T&>(value);
+                }
+
+                constexpr auto do_get() const& noexcept
+                    -> T const&
+                {
+                    return static_cast<T const&>(value);
+                }
+
+                constexpr auto do_get() && noexcept
+                    -> T&&
+                {
+                    return static_cast<T&&>(value);
+                }
+
+                constexpr auto do_get() const&& noexcept
+                    -> T const&&
+                {
+                    return static_cast<T const&&>(value);
+                }
+        };
+#endif
+
         ////////////////////////////////////////////////////////////
         // Whether the array elements need to be swapped
 
@@ -1044,6 +1192,79 @@ namespace cruft
         }
     }
 
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Uses-allocator construction of the members of a pair:
+        // the arguments are turned into a tuple suitable for the
+        // piecewise constructor, passing the allocator to members
+        // that use it with either of the standard conventions
+
+        template<typename T, typename Alloc, typename... Args>
+        struct is_uses_allocator_constructible:
+            std::conditional_t<
+                std::uses_allocator_v<std::remove_cv_t<T>, Alloc>,
+                std::disjunction<
+                    std::is_constructible<T, std::allocator_arg_t, Alloc const&, Args...>,
+                    std::is_constructible<T, Args..., Alloc const&>
+                >,
+                std::is_constructible<T, Args...>
+            >
+        {};
+
+        template<typename T, typename Alloc, typename... Args>
+        constexpr auto uses_allocator_args(Alloc const& alloc, Args&&... args) noexcept
+        {
+            if constexpr (not std::uses_allocator_v<std::remove_cv_t<T>, Alloc>) {
+                return std::forward_as_tuple(std::forward<Args>(args)...);
+            } else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, Alloc const&, Args...>) {
+                return std::tuple<std::allocator_arg_t, Alloc const&, Args&&...>(
+                    std::allocator_arg, alloc, std::forward<Args>(args)...
+                );
+            } else {
+                return std::forward_as_tuple(std::forward<Args>(args)..., alloc);
+            }
+        }
+
+        // pair_like eagerly instantiates get<1> which isn't SFINAE-friendly
+        // on smaller tuples, so check the size first
+        template<typename T, typename = void>
+        struct has_two_elements:
+            std::false_type
+        {};
+
+        template<typename T>
+        struct has_two_elements<T, std::void_t<decltype(std::tuple_size<T>::value)>>:
+            std::bool_constant<std::tuple_size<T>::value == 2>
+        {};
+
+        template<typename T>
+        struct is_pair_like_argument:
+            std::conjunction<
+                has_two_elements<std::remove_cv_t<std::remove_reference_t<T>>>,
+                pair_like<std::remove_reference_t<T>>
+            >
+        {};
+
+        // Only instantiated for pair-like arguments, whose elements
+        // can be accessed with std::get
+        template<typename T1, typename T2, typename Alloc, typename Tuple>
+        struct is_uses_allocator_constructible_from_pair_like:
+            std::conjunction<
+                is_uses_allocator_constructible<T1, Alloc, decltype(std::get<0>(std::declval<Tuple>()))>,
+                is_uses_allocator_constructible<T2, Alloc, decltype(std::get<1>(std::declval<Tuple>()))>
+            >
+        {};
+
+        template<typename T, typename Alloc, typename Tuple>
+        constexpr auto uses_allocator_tuple_args(Alloc const& alloc, Tuple&& args) noexcept
+        {
+            return std::apply([&alloc](auto&&... elems) {
+                return uses_allocator_args<T>(alloc, std::forward<decltype(elems)>(elems)...);
+            }, std::forward<Tuple>(args));
+        }
+    }
+
     ////////////////////////////////////////////////////////////
     // Main class
 
@@ -1263,6 +1484,107 @@ namespace cruft
                                                        std::forward<Tuple2>(second_args))
             {}
 
+            ////////////////////////////////////////////////////////////
+            // Allocator-extended constructors: like those of std::tuple,
+            // they construct the members that use the allocator with it
+            // and ignore it for the other members
+
+            template<
+                typename Alloc,
+                std::enable_if_t<
+                    detail::is_uses_allocator_constructible<T1, Alloc>::value &&
+                    detail::is_uses_allocator_constructible<T2, Alloc>::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc):
+                tight_pair(std::piecewise_construct,
+                           detail::uses_allocator_args<T1>(alloc),
+                           detail::uses_allocator_args<T2>(alloc))
+            {}
+
+            template<
+                typename Alloc,
+                typename U1,
+                typename U2,
+                std::enable_if_t<
+                    detail::is_uses_allocator_constructible<T1, Alloc, U1>::value &&
+                    detail::is_uses_allocator_constructible<T2, Alloc, U2>::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc, U1&& first, U2&& second):
+                tight_pair(std::piecewise_construct,
+                           detail::uses_allocator_args<T1>(alloc, std::forward<U1>(first)),
+                           detail::uses_allocator_args<T2>(alloc, std::forward<U2>(second)))
+            {}
+
+            template<
+                typename Alloc,
+                typename U1,
+                typename U2,
+                std::enable_if_t<
+                    detail::is_uses_allocator_constructible<T1, Alloc, U1 const&>::value &&
+                    detail::is_uses_allocator_constructible<T2, Alloc, U2 const&>::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc, tight_pair<U1, U2> const& pair):
+                tight_pair(std::piecewise_construct,
+                           detail::uses_allocator_args<T1>(alloc, pair.template get<0>()),
+                           detail::uses_allocator_args<T2>(alloc, pair.template get<1>()))
+            {}
+
+            template<
+                typename Alloc,
+                typename U1,
+                typename U2,
+                std::enable_if_t<
+                    detail::is_uses_allocator_constructible<T1, Alloc, U1&&>::value &&
+                    detail::is_uses_allocator_constructible<T2, Alloc, U2&&>::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc, tight_pair<U1, U2>&& pair):
+                tight_pair(std::piecewise_construct,
+                           detail::uses_allocator_args<T1>(alloc, std::forward<U1>(pair.template get<0>())),
+                           detail::uses_allocator_args<T2>(alloc, std::forward<U2>(pair.template get<1>())))
+            {}
+
+            template<
+                typename Alloc,
+                typename Tuple,
+                std::enable_if_t<
+                    std::conjunction<
+                        detail::is_pair_like_argument<Tuple>,
+                        detail::is_uses_allocator_constructible_from_pair_like<T1, T2, Alloc, Tuple>
+                    >::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc, Tuple&& tuple):
+                tight_pair(std::allocator_arg, alloc,
+                           std::get<0>(std::forward<Tuple>(tuple)),
+                           std::get<1>(std::forward<Tuple>(tuple)))
+            {}
+
+            template<
+                typename Alloc,
+                typename... Args1,
+                typename... Args2,
+                std::enable_if_t<
+                    detail::is_uses_allocator_constructible<T1, Alloc, Args1...>::value &&
+                    detail::is_uses_allocator_constructible<T2, Alloc, Args2...>::value,
+                    bool
+                > = false
+            >
+            constexpr tight_pair(std::allocator_arg_t, Alloc const& alloc, std::piecewise_construct_t,
+                                 std::tuple<Args1...> first_args, std::tuple<Args2...> second_args):
+                tight_pair(std::piecewise_construct,
+                           detail::uses_allocator_tuple_args<T1>(alloc, std::move(first_args)),
+                           detail::uses_allocator_tuple_args<T2>(alloc, std::move(second_args)))
+            {}
+
             ////////////////////////////////////////////////////////////
             // Assignment operator
 
@@ -1450,6 +1772,11 @@ namespace cruft
                     auto big_lhs = detail::get_twice_as_big(lhs);
                     auto big_rhs = detail::get_twice_as_big(rhs);
                     return big_lhs < big_rhs;
+                } else if constexpr (detail::has_three_way_compare<T1>::value) {
+                    if (auto cmp = lhs.get<0>().compare(rhs.get<0>()) ; cmp != 0) {
+                        return cmp < 0;
+                    }
+                    return lhs.get<1>() < rhs.get<1>();
                 } else {
                     if (lhs.get<0>() < rhs.get<0>()) {
                         return true;
@@ -1517,6 +1844,14 @@ namespace cruft
     tight_pair(std::reference_wrapper<T1>, std::reference_wrapper<T2>)
         -> tight_pair<T1&, T2&>;
 
+    template<typename Alloc, typename T1, typename T2>
+    tight_pair(std::allocator_arg_t, Alloc, T1, T2)
+        -> tight_pair<T1, T2>;
+
+    template<typename Alloc, typename T1, typename T2>
+    tight_pair(std::allocator_arg_t, Alloc, tight_pair<T1, T2>)
+        -> tight_pair<T1, T2>;
+
     ////////////////////////////////////////////////////////////
     // Free swap function
 
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_BLOOM_FILTER_H_
+#define CRUFT_TIGHT_PAIR_BLOOM_FILTER_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../tight_pair.h"
+#include "hash_table.h"
+#include "serialization.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Split block Bloom filter: every key sets one bit in each
+        // of the 8 words of a cache line sized block. The low half
+        // of the hash picks the bits through multiplications by odd
+        // salts, the high half picks the block
+
+        constexpr std::size_t bloom_block_words = 8;
+        constexpr std::size_t bloom_block_bits = bloom_block_words * 64;
+        // Keys hashed ahead of their lookups in batched queries
+        constexpr std::size_t bloom_batch_size = 16;
+
+        constexpr std::uint32_t bloom_salts[bloom_block_words] = {
+            0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+            0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+        };
+
+        struct alignas(64) bloom_block
+        {
+            std::uint64_t words[bloom_block_words] = {};
+        };
+
+        inline auto bloom_bit(std::uint64_t hash, std::size_t word) noexcept
+            -> std::uint64_t
+        {
+            auto low = static_cast<std::uint32_t>(hash);
+            return std::uint64_t(1) << ((low * bloom_salts[word]) >> 26);
+        }
+
+        inline auto prefetch(void const* address) noexcept
+            -> void
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#else
+            (void) address;
+#endif
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Blocked Bloom filter of packable pairs
+    //
+    // Answers whether a pair might have been inserted, without
+    // false negatives: every query touches a single cache line and
+    // hashes the packed representation of the pair once. With the
+    // default 10 bits per expected element, the false positive
+    // rate is about 1%.
+
+    template<typename T1, typename T2, typename Hash=pair_hash>
+    class pair_bloom_filter
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = tight_pair<T1, T2>;
+            using size_type = std::size_t;
+            using hasher = Hash;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit pair_bloom_filter(size_type expected_elements,
+                                       double bits_per_element=10.0,
+                                       Hash hash=Hash()):
+                blocks_(block_count_for(expected_elements, bits_per_element)),
+                hash_(std::move(hash))
+            {}
+
+            ////////////////////////////////////////////////////////////
+            // Observers
+
+            auto block_count() const noexcept
+                -> size_type
+            {
+                return blocks_.size();
+            }
+
+            auto size_in_bytes() const noexcept
+                -> size_type
+            {
+                return blocks_.size() * sizeof(detail::bloom_block);
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Modifiers
+
+            auto insert(value_type const& value)
+                -> void
+            {
+                auto hash = hash_value(value);
+                auto& block = block_for(hash);
+                for (std::size_t i = 0 ; i < detail::bloom_block_words ; ++i) {
+                    block.words[i] |= detail::bloom_bit(hash, i);
+                }
+            }
+
+            template<typename InputIterator>
+            auto insert(InputIterator first, InputIterator last)
+                -> void
+            {
+                for (; first != last ; ++first) {
+                    insert(*first);
+                }
+            }
+
+            auto clear() noexcept
+                -> void
+            {
+                for (auto& block: blocks_) {
+                    block = detail::bloom_block{};
+                }
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Lookup
+
+            auto contains(value_type const& value) const
+                -> bool
+            {
+                auto hash = hash_value(value);
+                return block_contains(block_for(hash), hash);
+            }
+
+            // Writes the result of contains for every pair of the
+            // range: the pairs are hashed and their blocks prefetched
+            // by batches, so that the memory accesses of a batch
+            // overlap
+            template<typename InputIterator, typename OutputIterator>
+            auto contains(InputIterator first, InputIterator last, OutputIterator out) const
+                -> OutputIterator
+            {
+                std::uint64_t hashes[detail::bloom_batch_size];
+                while (first != last) {
+                    std::size_t count = 0;
+                    for (; count < detail::bloom_batch_size && first != last ; ++count, ++first) {
+                        hashes[count] = hash_value(*first);
+                        detail::prefetch(&block_for(hashes[count]));
+                    }
+                    for (std::size_t i = 0 ; i < count ; ++i) {
+                        *out = block_contains(block_for(hashes[i]), hashes[i]);
+                        ++out;
+                    }
+                }
+                return out;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Serialization
+            //
+            // The filter is written as the number of blocks followed
+            // by the words of every block, all of them as big-endian
+            // 64-bit integers. The hash function isn't stored, a
+            // filter must be read with the one it was written with.
+
+            auto write(std::ostream& stream) const
+                -> std::ostream&
+            {
+                unsigned char buffer[sizeof(std::uint64_t) * detail::bloom_block_words];
+                detail::store_big_endian(std::uint64_t(blocks_.size()), buffer);
+                if (not stream.write(reinterpret_cast<char const*>(buffer), sizeof(std::uint64_t))) {
+                    return stream;
+                }
+                for (auto const& block: blocks_) {
+                    auto out = buffer;
+                    for (auto word: block.words) {
+                        out = detail::store_big_endian(word, out);
+                    }
+                    if (not stream.write(reinterpret_cast<char const*>(buffer), sizeof(buffer))) {
+                        break;
+                    }
+                }
+                return stream;
+            }
+
+            // Throws std::runtime_error if the stream doesn't contain
+            // a whole filter
+            static auto read(std::istream& stream, Hash hash=Hash())
+                -> pair_bloom_filter
+            {
+                unsigned char buffer[sizeof(std::uint64_t) * detail::bloom_block_words];
+                if (not stream.read(reinterpret_cast<char*>(buffer), sizeof(std::uint64_t))) {
+                    throw std::runtime_error("could not read the size of the Bloom filter");
+                }
+                auto nb_blocks = detail::load_big_endian<std::uint64_t>(buffer);
+                if (nb_blocks == 0) {
+                    throw std::runtime_error("invalid Bloom filter without blocks");
+                }
+
+                pair_bloom_filter res(std::move(hash));
+                for (std::uint64_t i = 0 ; i < nb_blocks ; ++i) {
+                    if (not stream.read(reinterpret_cast<char*>(buffer), sizeof(buffer))) {
+                        throw std::runtime_error("truncated Bloom filter");
+                    }
+                    detail::bloom_block block;
+                    for (std::size_t j = 0 ; j < detail::bloom_block_words ; ++j) {
+                        block.words[j] = detail::load_big_endian<std::uint64_t>(buffer + 8 * j);
+                    }
+                    res.blocks_.push_back(block);
+                }
+                return res;
+            }
+
+        private:
+
+            explicit pair_bloom_filter(Hash hash):
+                hash_(std::move(hash))
+            {}
+
+            static auto block_count_for(size_type expected_elements, double bits_per_element)
+                -> size_type
+            {
+                auto bits = static_cast<double>(expected_elements) * bits_per_element;
+                auto nb_blocks = static_cast<size_type>(bits / detail::bloom_block_bits) + 1;
+                return nb_blocks;
+            }
+
+            auto hash_value(value_type const& value) const
+                -> std::uint64_t
+            {
+                auto hash = hash_(value);
+                if constexpr (sizeof(hash) < sizeof(std::uint64_t)) {
+                    // Both halves of the hash are used, spread narrower
+                    // hashes over 64 bits so that the high half isn't 0
+                    return detail::mix_hash(hash);
+                } else {
+                    return hash;
+                }
+            }
+
+            auto block_for(std::uint64_t hash) const noexcept
+                -> detail::bloom_block const&
+            {
+                // Maps the high half of the hash to [0, block count)
+                // with a multiplication instead of a modulo
+                size_type index = ((hash >> 32) * blocks_.size()) >> 32;
+                return blocks_[index];
+            }
+
+            auto block_for(std::uint64_t hash) noexcept
+                -> detail::bloom_block&
+            {
+                size_type index = ((hash >> 32) * blocks_.size()) >> 32;
+                return blocks_[index];
+            }
+
+            static auto block_contains(detail::bloom_block const& block, std::uint64_t hash) noexcept
+                -> bool
+            {
+                // No early exit: the 8 words are checked at once
+                std::uint64_t missing = 0;
+                for (std::size_t i = 0 ; i < detail::bloom_block_words ; ++i) {
+                    auto bit = detail::bloom_bit(hash, i);
+                    missing |= (block.words[i] & bit) ^ bit;
+                }
+                return missing == 0;
+            }
+
+            std::vector<detail::bloom_block> blocks_;
+            Hash hash_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_BLOOM_FILTER_H_
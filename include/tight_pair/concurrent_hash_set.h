@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_CONCURRENT_HASH_SET_H_
+#define CRUFT_TIGHT_PAIR_CONCURRENT_HASH_SET_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+#include "hash_table.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Whether a concurrent_pair_set is allowed to grow when it
+    // gets too full, or throws std::length_error instead
+
+    enum struct resize_policy
+    {
+        grow,
+        fixed
+    };
+
+    namespace detail
+    {
+        // Number of slots migrated at once by a thread helping
+        // with a resize
+        constexpr std::size_t migration_chunk = 1024;
+
+        ////////////////////////////////////////////////////////////
+        // Array of atomic slots with linear probing: a slot is
+        // either empty, holds a packed key, or is marked as moved
+        // when its content has been copied to the next table during
+        // a resize. The two sentinel words are never stored in the
+        // slots, the set tracks those keys separately
+
+        template<typename Word>
+        struct concurrent_table
+        {
+            static constexpr Word empty = Word(0);
+            static constexpr Word moved = std::numeric_limits<Word>::max();
+
+            explicit concurrent_table(std::size_t capacity):
+                capacity(capacity),
+                slots(new std::atomic<Word>[capacity])
+            {
+                for (std::size_t i = 0 ; i < capacity ; ++i) {
+                    slots[i].store(empty, std::memory_order_relaxed);
+                }
+            }
+
+            auto max_load() const noexcept
+                -> std::size_t
+            {
+                // Linear probing degrades quickly past half full
+                return capacity / 2;
+            }
+
+            std::size_t capacity;
+            std::unique_ptr<std::atomic<Word>[]> slots;
+            // Number of claimed slots, including copied keys
+            std::atomic<std::size_t> load{0};
+            std::atomic<concurrent_table*> next{nullptr};
+            // Migration progress: chunks handed out and slots moved
+            std::atomic<std::size_t> migration_cursor{0};
+            std::atomic<std::size_t> migrated{0};
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Lock-free set of packable pairs
+    //
+    // Every key is a packed integer that fits in a lock-free
+    // atomic word, so inserting a key only needs to claim an empty
+    // slot with a single compare-and-swap. insert and contains can
+    // be called concurrently from any number of threads: contains
+    // never blocks, and insert only waits during a resize.
+    //
+    // When the table gets half full, the next insertion allocates
+    // a table twice as big and every thread that subsequently
+    // touches the set helps moving chunks of slots to it. A key is
+    // copied before its slot is marked as moved, so a lookup that
+    // doesn't find a key in a table being migrated can continue in
+    // the next table.
+    // Tables replaced during a resize are only freed when the set
+    // is destroyed, which bounds the wasted memory to the size of
+    // the current table.
+
+    template<typename T1, typename T2, typename Hash=pair_hash>
+    class concurrent_pair_set
+    {
+        static_assert(std::is_same_v<T1, T2> && detail::can_optimize_compare<T1>::value,
+                      "concurrent_pair_set only supports pairs that can be represented "
+                      "by a packed integer");
+
+        using key_word = decltype(detail::twice_as_big<T1>());
+        using table_type = detail::concurrent_table<key_word>;
+
+        static_assert(std::atomic<key_word>::is_always_lock_free,
+                      "the packed representation of the pair must be a lock-free atomic type");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = tight_pair<T1, T2>;
+            using size_type = std::size_t;
+            using hasher = Hash;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit concurrent_pair_set(size_type capacity=1024,
+                                         resize_policy policy=resize_policy::grow,
+                                         Hash hash=Hash()):
+                policy_(policy),
+                hash_(std::move(hash))
+            {
+                // Enough slots to hold capacity elements under the
+                // maximal load factor
+                size_type nb_slots = 16;
+                while (nb_slots / 2 < capacity) {
+                    nb_slots *= 2;
+                }
+                first_ = new table_type(nb_slots);
+                current_.store(first_, std::memory_order_relaxed);
+            }
+
+            concurrent_pair_set(concurrent_pair_set const&) = delete;
+            auto operator=(concurrent_pair_set const&) -> concurrent_pair_set& = delete;
+
+            ~concurrent_pair_set()
+            {
+                auto table = first_;
+                while (table) {
+                    auto next = table->next.load(std::memory_order_relaxed);
+                    delete table;
+                    table = next;
+                }
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+
+            // Exact when no insertion is in progress
+            auto size() const noexcept
+                -> size_type
+            {
+                return size_.load(std::memory_order_relaxed);
+            }
+
+            auto empty() const noexcept
+                -> bool
+            {
+                return size() == 0;
+            }
+
+            // Number of slots of the most recent table
+            auto capacity() const noexcept
+                -> size_type
+            {
+                auto table = current_.load(std::memory_order_acquire);
+                while (auto next = table->next.load(std::memory_order_acquire)) {
+                    table = next;
+                }
+                return table->capacity;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Operations
+
+            // Returns whether the value was inserted, throws
+            // std::length_error if the set is full and can't grow;
+            // an insertion that meets a resize in progress helps it
+            // and waits until every key has been moved
+            auto insert(value_type const& value)
+                -> bool
+            {
+                key_word word = detail::get_twice_as_big(value);
+                bool inserted;
+                if (word == table_type::empty) {
+                    inserted = not has_empty_key_.exchange(true, std::memory_order_acq_rel);
+                } else if (word == table_type::moved) {
+                    inserted = not has_moved_key_.exchange(true, std::memory_order_acq_rel);
+                } else {
+                    inserted = insert_word(current_.load(std::memory_order_acquire), word, hash(value));
+                }
+                if (inserted) {
+                    size_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return inserted;
+            }
+
+            auto contains(value_type const& value) const
+                -> bool
+            {
+                key_word word = detail::get_twice_as_big(value);
+                if (word == table_type::empty) {
+                    return has_empty_key_.load(std::memory_order_acquire);
+                }
+                if (word == table_type::moved) {
+                    return has_moved_key_.load(std::memory_order_acquire);
+                }
+
+                auto key_hash = hash(value);
+                auto table = current_.load(std::memory_order_acquire);
+                for (;;) {
+                    auto next = table->next.load(std::memory_order_acquire);
+                    if (next && table->migrated.load(std::memory_order_acquire) == table->capacity) {
+                        // Every key was moved to the next table already
+                        table = next;
+                        continue;
+                    }
+
+                    // Slots of a table being migrated are moved in any
+                    // order, so a moved slot doesn't mean that the key
+                    // was moved: skip it and keep probing
+                    auto mask = table->capacity - 1;
+                    auto index = key_hash & mask;
+                    for (std::size_t probes = 0 ; probes < table->capacity ; ++probes) {
+                        auto slot = table->slots[index].load(std::memory_order_acquire);
+                        if (slot == word) {
+                            return true;
+                        }
+                        if (slot == table_type::empty) {
+                            break;
+                        }
+                        index = (index + 1) & mask;
+                    }
+                    // The key can still have been moved to the next table
+                    // if a migration started, keys are copied there before
+                    // their slot is marked as moved
+                    table = table->next.load(std::memory_order_acquire);
+                    if (table == nullptr) {
+                        return false;
+                    }
+                }
+            }
+
+        private:
+
+            auto hash(value_type const& value) const
+                -> std::size_t
+            {
+                return static_cast<std::size_t>(hash_(value));
+            }
+
+            auto insert_word(table_type* table, key_word word, std::size_t key_hash)
+                -> bool
+            {
+                for (;;) {
+                    if (policy_ == resize_policy::grow
+                        && table->load.load(std::memory_order_relaxed) >= table->max_load()) {
+                        start_migration(table);
+                    }
+                    if (auto next = table->next.load(std::memory_order_acquire)) {
+                        help_migration(table);
+                        table = next;
+                        continue;
+                    }
+
+                    auto mask = table->capacity - 1;
+                    auto index = key_hash & mask;
+                    for (std::size_t probes = 0 ; probes < table->capacity ; ++probes) {
+                        auto& slot = table->slots[index];
+                        auto current = slot.load(std::memory_order_acquire);
+                        if (current == table_type::empty) {
+                            if (slot.compare_exchange_strong(current, word,
+                                                             std::memory_order_acq_rel,
+                                                             std::memory_order_acquire)) {
+                                table->load.fetch_add(1, std::memory_order_relaxed);
+                                return true;
+                            }
+                            // Another thread claimed or moved the slot in
+                            // the meantime, current holds its new value
+                        }
+                        if (current == word) {
+                            return false;
+                        }
+                        if (current == table_type::moved) {
+                            break;
+                        }
+                        index = (index + 1) & mask;
+                    }
+
+                    // The key wasn't found before a moved slot, or the
+                    // table is full: continue in the next table once
+                    // every key was moved there, so that the key can't
+                    // be concurrently inserted in both tables
+                    if (policy_ == resize_policy::fixed) {
+                        throw std::length_error("concurrent_pair_set is full");
+                    }
+                    start_migration(table);
+                    help_migration(table);
+                    table = table->next.load(std::memory_order_acquire);
+                }
+            }
+
+            auto start_migration(table_type* table)
+                -> void
+            {
+                if (table->next.load(std::memory_order_acquire)) {
+                    return;
+                }
+                auto next = new table_type(table->capacity * 2);
+                table_type* expected = nullptr;
+                if (not table->next.compare_exchange_strong(expected, next,
+                                                            std::memory_order_acq_rel,
+                                                            std::memory_order_acquire)) {
+                    // Another thread started the migration first
+                    delete next;
+                }
+            }
+
+            // Moves chunks of slots to the next table until no chunk
+            // is left, then waits for the other helpers to finish
+            // theirs so that every key of the table is reachable from
+            // the next one
+            auto help_migration(table_type* table)
+                -> void
+            {
+                auto next = table->next.load(std::memory_order_acquire);
+                for (;;) {
+                    auto begin = table->migration_cursor.fetch_add(detail::migration_chunk,
+                                                                   std::memory_order_relaxed);
+                    if (begin >= table->capacity) {
+                        break;
+                    }
+                    auto end = std::min(begin + detail::migration_chunk, table->capacity);
+                    for (auto index = begin ; index < end ; ++index) {
+                        migrate_slot(table, next, index);
+                    }
+                    table->migrated.fetch_add(end - begin, std::memory_order_acq_rel);
+                }
+
+                while (table->migrated.load(std::memory_order_acquire) < table->capacity) {
+                    std::this_thread::yield();
+                }
+                publish_tables();
+            }
+
+            // Makes the most recent fully populated table the entry
+            // point of the set
+            auto publish_tables()
+                -> void
+            {
+                auto table = current_.load(std::memory_order_acquire);
+                for (;;) {
+                    auto next = table->next.load(std::memory_order_acquire);
+                    if (next == nullptr
+                        || table->migrated.load(std::memory_order_acquire) < table->capacity) {
+                        return;
+                    }
+                    if (current_.compare_exchange_strong(table, next,
+                                                         std::memory_order_acq_rel,
+                                                         std::memory_order_acquire)) {
+                        table = next;
+                    }
+                }
+            }
+
+            auto migrate_slot(table_type* table, table_type* next, std::size_t index)
+                -> void
+            {
+                auto& slot = table->slots[index];
+                auto current = slot.load(std::memory_order_acquire);
+                for (;;) {
+                    if (current == table_type::empty) {
+                        if (slot.compare_exchange_strong(current, table_type::moved,
+                                                         std::memory_order_acq_rel,
+                                                         std::memory_order_acquire)) {
+                            return;
+                        }
+                        // An insertion claimed the slot, move its key
+                        continue;
+                    }
+                    // Copy the key before marking the slot, so that a
+                    // thread meeting the mark finds the key in the next
+                    // table; only the owner of the chunk writes a mark
+                    // on a full slot and full slots never change, so a
+                    // plain store is enough
+                    insert_word(next, current, hash(detail::from_twice_as_big<T1>(current)));
+                    slot.store(table_type::moved, std::memory_order_release);
+                    return;
+                }
+            }
+
+            table_type* first_;
+            std::atomic<table_type*> current_;
+            std::atomic<size_type> size_{0};
+            std::atomic<bool> has_empty_key_{false};
+            std::atomic<bool> has_moved_key_{false};
+            resize_policy policy_;
+            Hash hash_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_CONCURRENT_HASH_SET_H_
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_CONVERT_H_
+#define CRUFT_TIGHT_PAIR_CONVERT_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        template<typename From, typename To>
+        struct can_convert_in_place:
+            std::bool_constant<
+                sizeof(From) == sizeof(To) &&
+                std::is_trivially_destructible_v<From> &&
+                std::is_trivially_destructible_v<To>
+            >
+        {};
+
+        template<typename To, typename From>
+        auto convert_in_place(From* first, From* last)
+            -> To*
+        {
+            static_assert(can_convert_in_place<From, To>::value,
+                          "in-place conversion requires trivially destructible types "
+                          "with the same size");
+            assert(reinterpret_cast<std::uintptr_t>(first) % alignof(To) == 0);
+
+            auto res = reinterpret_cast<To*>(first);
+            for (; first != last; ++first) {
+                // Read the elements, end the lifetime of the original
+                // object by reusing its storage for the new one
+                using std::get;
+                auto elem0 = get<0>(std::move(*first));
+                auto elem1 = get<1>(std::move(*first));
+                ::new(static_cast<void*>(first)) To(std::move(elem0), std::move(elem1));
+            }
+            return std::launder(res);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Bulk conversions between arrays of std::pair and arrays of
+    // cruft::tight_pair
+    //
+    // The loops are kept simple on purpose: when the elements of
+    // tight_pair<T, T> are stored in reverse order, the compilers
+    // turn them into vectorized shuffles running at memory speed
+
+    template<typename T1, typename T2>
+    auto convert(std::pair<T1, T2> const* first, std::pair<T1, T2> const* last,
+                 tight_pair<T1, T2>* out)
+        -> tight_pair<T1, T2>*
+    {
+        for (; first != last; ++first, (void) ++out) {
+            *out = tight_pair<T1, T2>(first->first, first->second);
+        }
+        return out;
+    }
+
+    template<typename T1, typename T2>
+    auto convert(tight_pair<T1, T2> const* first, tight_pair<T1, T2> const* last,
+                 std::pair<T1, T2>* out)
+        -> std::pair<T1, T2>*
+    {
+        using cruft::get;
+        for (; first != last; ++first, (void) ++out) {
+            *out = std::pair<T1, T2>(get<0>(*first), get<1>(*first));
+        }
+        return out;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // In-place conversions: the objects of the original array are
+    // replaced by objects of the other type in the same storage,
+    // a pointer to the first element of the converted array is
+    // returned, the original pointers must not be used anymore
+    //
+    // tight_pair<T, T> might be more aligned than std::pair<T, T>
+    // when its elements are packed, in which case the storage of
+    // the std::pair array must be suitably aligned
+
+    template<typename T1, typename T2>
+    auto convert_in_place(std::pair<T1, T2>* first, std::pair<T1, T2>* last)
+        -> tight_pair<T1, T2>*
+    {
+        return detail::convert_in_place<tight_pair<T1, T2>>(first, last);
+    }
+
+    template<typename T1, typename T2>
+    auto convert_in_place(tight_pair<T1, T2>* first, tight_pair<T1, T2>* last)
+        -> std::pair<T1, T2>*
+    {
+        return detail::convert_in_place<std::pair<T1, T2>>(first, last);
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_CONVERT_H_
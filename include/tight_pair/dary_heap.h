@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_DARY_HEAP_H_
+#define CRUFT_TIGHT_PAIR_DARY_HEAP_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Allocator returning cache-line aligned memory
+
+        template<typename T>
+        struct cache_aligned_allocator
+        {
+            using value_type = T;
+
+            static constexpr std::size_t alignment = alignof(T) > 64 ? alignof(T) : 64;
+
+            cache_aligned_allocator() = default;
+
+            template<typename U>
+            constexpr cache_aligned_allocator(cache_aligned_allocator<U> const&) noexcept {}
+
+            auto allocate(std::size_t n)
+                -> T*
+            {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+            }
+
+            auto deallocate(T* ptr, std::size_t) noexcept
+                -> void
+            {
+                ::operator delete(ptr, std::align_val_t(alignment));
+            }
+
+            template<typename U>
+            friend constexpr auto operator==(cache_aligned_allocator const&, cache_aligned_allocator<U> const&) noexcept
+                -> bool
+            {
+                return true;
+            }
+
+            template<typename U>
+            friend constexpr auto operator!=(cache_aligned_allocator const&, cache_aligned_allocator<U> const&) noexcept
+                -> bool
+            {
+                return false;
+            }
+        };
+
+        ////////////////////////////////////////////////////////////
+        // Key greater than or equivalent to every other key for the
+        // packed comparisons, used to pad the last group of children
+
+        template<typename Key, typename Compare>
+        struct heap_sentinel;
+
+        template<typename Key>
+        struct heap_sentinel<Key, std::less<>>
+        {
+            static constexpr Key value = static_cast<Key>(-1);
+        };
+
+        template<typename Key>
+        struct heap_sentinel<Key, std::greater<>>
+        {
+            static constexpr Key value = 0;
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // d-ary heap where top() is the smallest element according
+    // to Compare (unlike std::priority_queue, which exposes the
+    // greatest one)
+    //
+    // The children of a node are stored contiguously and the
+    // storage is offset so that every group of children starts on
+    // a cache line boundary: with D * sizeof(key) == 64, finding
+    // the smallest child touches a single cache line. Packable
+    // pairs compared with std::less or std::greater are stored as
+    // packed integers, and the last group of children is padded
+    // with a sentinel so that the smallest child is found with a
+    // fixed-size branchless loop
+
+    template<typename T, std::size_t D=4, typename Compare=std::less<>>
+    class dary_heap
+    {
+        static_assert(D >= 2, "a d-ary heap needs at least 2 children per node");
+
+        using adapter = detail::packed_key_adapter<T, Compare>;
+        using key_type = typename adapter::key_type;
+        using key_compare = typename adapter::compare_type;
+
+        // Unused elements before the root, so that children groups
+        // of packed keys are aligned
+        static constexpr std::size_t offset = adapter::is_packed ? D - 1 : 0;
+        // Padding plus the slot of the root, always allocated
+        static constexpr std::size_t base_size = D;
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = T;
+            using size_type = std::size_t;
+            using value_compare = Compare;
+
+            static constexpr size_type arity = D;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            dary_heap():
+                dary_heap(Compare{})
+            {}
+
+            explicit dary_heap(Compare compare):
+                compare_(adapter::compare(compare)),
+                storage_()
+            {
+                if constexpr (adapter::is_packed) {
+                    storage_.assign(base_size, sentinel());
+                }
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+
+            auto empty() const noexcept
+                -> bool
+            {
+                return size_ == 0;
+            }
+
+            auto size() const noexcept
+                -> size_type
+            {
+                return size_;
+            }
+
+            auto reserve(size_type new_cap)
+                -> void
+            {
+                storage_.reserve(offset + new_cap + D);
+            }
+
+            auto clear() noexcept
+                -> void
+            {
+                if constexpr (adapter::is_packed) {
+                    storage_.assign(base_size, sentinel());
+                } else {
+                    storage_.clear();
+                }
+                size_ = 0;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+
+            auto top() const
+                -> value_type
+            {
+                return value_type(adapter::from_key(storage_[offset]));
+            }
+
+            // Elements in heap order, positions change whenever the
+            // heap is modified
+            auto operator[](size_type pos) const
+                -> value_type
+            {
+                return value_type(adapter::from_key(storage_[offset + pos]));
+            }
+
+            // Position of an element equal to value, or size() when
+            // there is none: linear search, meant to feed decrease_key
+            auto find(value_type const& value) const
+                -> size_type
+            {
+                auto first = storage_.data() + offset;
+                auto&& key = adapter::to_key(value);
+                return static_cast<size_type>(std::find(first, first + size_, key) - first);
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Modifiers
+
+            auto push(value_type const& value)
+                -> void
+            {
+                if constexpr (adapter::is_packed) {
+                    // Starting a new group of children: pad it
+                    if ((offset + size_) % D == 0) {
+                        storage_.resize(storage_.size() + D, sentinel());
+                    }
+                    storage_[offset + size_] = adapter::to_key(value);
+                } else {
+                    storage_.push_back(adapter::to_key(value));
+                }
+                ++size_;
+                sift_up(size_ - 1, adapter::to_key(value));
+            }
+
+            auto pop()
+                -> void
+            {
+                --size_;
+                key_type last = std::move(storage_[offset + size_]);
+                if constexpr (adapter::is_packed) {
+                    storage_[offset + size_] = sentinel();
+                    if ((offset + size_) % D == 0) {
+                        storage_.resize(storage_.size() - D);
+                    }
+                } else {
+                    storage_.pop_back();
+                }
+                if (size_ > 0) {
+                    sift_down(0, std::move(last));
+                }
+            }
+
+            // Replace the element at pos, as returned by find(), with
+            // a value that doesn't compare greater than it
+            auto decrease_key(size_type pos, value_type const& value)
+                -> void
+            {
+                sift_up(pos, adapter::to_key(value));
+            }
+
+        private:
+
+            static constexpr auto sentinel() noexcept
+                -> key_type
+            {
+                return detail::heap_sentinel<key_type, key_compare>::value;
+            }
+
+            auto data() noexcept
+                -> key_type*
+            {
+                return storage_.data() + offset;
+            }
+
+            auto sift_up(size_type pos, key_type key)
+                -> void
+            {
+                auto base = data();
+                while (pos > 0) {
+                    auto parent = (pos - 1) / D;
+                    if (not compare_(key, base[parent])) {
+                        break;
+                    }
+                    base[pos] = std::move(base[parent]);
+                    pos = parent;
+                }
+                base[pos] = std::move(key);
+            }
+
+            auto min_child(size_type first_child) const
+                -> size_type
+            {
+                auto children = storage_.data() + offset + first_child;
+                size_type best = 0;
+                if constexpr (adapter::is_packed) {
+                    // The whole group is valid thanks to the padding,
+                    // the loop has a fixed size and is branchless
+                    key_type best_key = children[0];
+                    for (size_type i = 1 ; i < D ; ++i) {
+                        bool smaller = compare_(children[i], best_key);
+                        best_key = smaller ? children[i] : best_key;
+                        best = smaller ? i : best;
+                    }
+                } else {
+                    auto nb_children = std::min(D, size_ - first_child);
+                    for (size_type i = 1 ; i < nb_children ; ++i) {
+                        if (compare_(children[i], children[best])) {
+                            best = i;
+                        }
+                    }
+                }
+                return first_child + best;
+            }
+
+            auto sift_down(size_type pos, key_type key)
+                -> void
+            {
+                auto base = data();
+                for (;;) {
+                    auto first_child = D * pos + 1;
+                    if (first_child >= size_) {
+                        break;
+                    }
+                    auto child = min_child(first_child);
+                    if (not compare_(base[child], key)) {
+                        break;
+                    }
+                    base[pos] = std::move(base[child]);
+                    pos = child;
+                }
+                base[pos] = std::move(key);
+            }
+
+            key_compare compare_;
+            std::vector<key_type, detail::cache_aligned_allocator<key_type>> storage_;
+            size_type size_ = 0;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_DARY_HEAP_H_
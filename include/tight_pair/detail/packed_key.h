@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_DETAIL_PACKED_KEY_H_
+#define CRUFT_TIGHT_PAIR_DETAIL_PACKED_KEY_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include "../../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Whether a type is a tight_pair<T, T> whose comparisons use
+        // its packed integer representation
+
+        template<typename T>
+        struct is_packable_pair:
+            std::false_type
+        {};
+
+        template<typename T>
+        struct is_packable_pair<tight_pair<T, T>>:
+            can_optimize_compare<T>
+        {};
+
+        template<typename T>
+        constexpr bool is_packable_pair_v = is_packable_pair<T>::value;
+
+        ////////////////////////////////////////////////////////////
+        // Key adapter: algorithms that store or compare many keys
+        // can store the packed integer representation of a pair
+        // instead of the pair itself when the comparison is one of
+        // the standard ones, and use a plain integer comparison
+
+        // Comparison to use on the packed integers, void when the
+        // packed representation can't be used
+        template<typename T, typename Compare>
+        struct packed_key_compare
+        {
+            using type = void;
+        };
+
+        template<typename T, typename KeyCompare>
+        struct packed_key_compare_if_optimizable
+        {
+            using type = std::conditional_t<can_optimize_compare<T>::value, KeyCompare, void>;
+        };
+
+        template<typename T>
+        struct packed_key_compare<tight_pair<T, T>, std::less<>>:
+            packed_key_compare_if_optimizable<T, std::less<>>
+        {};
+
+        template<typename T>
+        struct packed_key_compare<tight_pair<T, T>, std::less<tight_pair<T, T>>>:
+            packed_key_compare_if_optimizable<T, std::less<>>
+        {};
+
+        template<typename T>
+        struct packed_key_compare<tight_pair<T, T>, std::greater<>>:
+            packed_key_compare_if_optimizable<T, std::greater<>>
+        {};
+
+        template<typename T>
+        struct packed_key_compare<tight_pair<T, T>, std::greater<tight_pair<T, T>>>:
+            packed_key_compare_if_optimizable<T, std::greater<>>
+        {};
+
+        template<
+            typename T,
+            typename Compare,
+            typename KeyCompare = typename packed_key_compare<T, Compare>::type
+        >
+        struct packed_key_adapter
+        {
+            static constexpr bool is_packed = true;
+
+            using element_type = std::tuple_element_t<0, T>;
+            using key_type = decltype(twice_as_big<element_type>());
+            using compare_type = KeyCompare;
+
+            static constexpr auto to_key(T const& value) noexcept
+                -> key_type
+            {
+                return get_twice_as_big(value);
+            }
+
+            static constexpr auto from_key(key_type key) noexcept
+                -> T
+            {
+                return from_twice_as_big<element_type>(key);
+            }
+
+            static constexpr auto compare(Compare const&)
+                -> KeyCompare
+            {
+                return {};
+            }
+        };
+
+        template<typename T, typename Compare>
+        struct packed_key_adapter<T, Compare, void>
+        {
+            static constexpr bool is_packed = false;
+
+            using key_type = T;
+            using compare_type = Compare;
+
+            static constexpr auto to_key(T const& value) noexcept
+                -> T const&
+            {
+                return value;
+            }
+
+            static constexpr auto from_key(T const& key) noexcept
+                -> T const&
+            {
+                return key;
+            }
+
+            static constexpr auto compare(Compare const& compare)
+                -> Compare
+            {
+                return compare;
+            }
+        };
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_DETAIL_PACKED_KEY_H_
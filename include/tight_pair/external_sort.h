@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_EXTERNAL_SORT_H_
+#define CRUFT_TIGHT_PAIR_EXTERNAL_SORT_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../tight_pair.h"
+#include "loser_tree.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Options of the external sorter
+
+    struct external_sort_options
+    {
+        // Approximate amount of memory used for the buffers
+        std::size_t memory_budget = std::size_t(256) * 1024 * 1024;
+
+        // Directory where the sorted runs are written
+        std::string temp_directory = ".";
+    };
+
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Sorted run spilled to a temporary file, the file is
+        // removed when the run is destroyed
+
+        struct file_deleter
+        {
+            auto operator()(std::FILE* file) const noexcept
+                -> void
+            {
+                std::fclose(file);
+            }
+        };
+
+        using file_ptr = std::unique_ptr<std::FILE, file_deleter>;
+
+        struct sorted_run
+        {
+            std::string path;
+            std::size_t size = 0;
+
+            sorted_run(std::string path, std::size_t size):
+                path(std::move(path)),
+                size(size)
+            {}
+
+            sorted_run(sorted_run const&) = delete;
+            sorted_run(sorted_run&& other) noexcept:
+                path(std::move(other.path)),
+                size(other.size)
+            {
+                other.path.clear();
+            }
+
+            ~sorted_run()
+            {
+                if (not path.empty()) {
+                    std::remove(path.c_str());
+                }
+            }
+        };
+
+        ////////////////////////////////////////////////////////////
+        // Buffered sequential reader over a run
+
+        template<typename Key>
+        class run_reader
+        {
+            public:
+
+                run_reader(sorted_run const& run, std::size_t buffer_size):
+                    file_(std::fopen(run.path.c_str(), "rb")),
+                    path_(&run.path),
+                    buffer_(std::max<std::size_t>(buffer_size, 1))
+                {
+                    if (not file_) {
+                        throw std::system_error(errno, std::generic_category(), run.path);
+                    }
+                    std::setvbuf(file_.get(), nullptr, _IONBF, 0);
+                }
+
+                // Returns false when the run is exhausted
+                auto next(Key& key)
+                    -> bool
+                {
+                    if (pos_ == end_) {
+                        end_ = std::fread(buffer_.data(), sizeof(Key), buffer_.size(), file_.get());
+                        pos_ = 0;
+                        if (end_ == 0) {
+                            if (std::ferror(file_.get())) {
+                                throw std::system_error(errno, std::generic_category(), *path_);
+                            }
+                            return false;
+                        }
+                    }
+                    key = buffer_[pos_++];
+                    return true;
+                }
+
+            private:
+
+                file_ptr file_;
+                std::string const* path_;
+                std::vector<Key> buffer_;
+                std::size_t pos_ = 0;
+                std::size_t end_ = 0;
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // External merge sort for collections of pairs which don't
+    // fit in memory
+    //
+    // Pairs are pushed one by one, or through the output iterator
+    // returned by sink(), then finish() writes them in sorted order
+    // to an output iterator. Whenever the memory budget is full,
+    // the buffered pairs are sorted and written to a temporary file
+    // as a sorted run; finish() then merges the runs with a loser
+    // tree, with intermediate merge passes when there are too many
+    // runs to give each of them a reasonably large read buffer.
+    //
+    // Only pairs of unsigned integers whose comparison can use the
+    // packed representation are supported: the runs contain the
+    // packed integers, so they are sorted, written, read and merged
+    // as plain integers. The temporary files are only meant to be
+    // read by the process that wrote them.
+
+    template<typename T1, typename T2>
+    class external_sorter
+    {
+        static_assert(std::is_same_v<T1, T2> && detail::can_optimize_compare<T1>::value,
+                      "external_sorter only supports pairs whose comparison can use "
+                      "their packed integer representation");
+
+        using key_type = decltype(detail::twice_as_big<T1>());
+
+        // Smallest read buffer given to a run during a merge
+        static constexpr std::size_t min_read_buffer_bytes = 1024 * 1024;
+
+        public:
+
+            using value_type = tight_pair<T1, T2>;
+
+            ////////////////////////////////////////////////////////////
+            // Output iterator pushing pairs to the sorter
+
+            class sink_iterator
+            {
+                public:
+
+                    using iterator_category = std::output_iterator_tag;
+                    using value_type = void;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = void;
+
+                    explicit sink_iterator(external_sorter& sorter) noexcept:
+                        sorter_(&sorter)
+                    {}
+
+                    auto operator=(tight_pair<T1, T2> const& value)
+                        -> sink_iterator&
+                    {
+                        sorter_->push(value);
+                        return *this;
+                    }
+
+                    auto operator*() noexcept -> sink_iterator& { return *this; }
+                    auto operator++() noexcept -> sink_iterator& { return *this; }
+                    auto operator++(int) noexcept -> sink_iterator { return *this; }
+
+                private:
+
+                    external_sorter* sorter_;
+            };
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit external_sorter(external_sort_options options={}):
+                options_(std::move(options)),
+                run_capacity_(std::max<std::size_t>(options_.memory_budget / sizeof(key_type), 1))
+            {
+                std::random_device device;
+                prefix_ = options_.temp_directory + "/tight_pair-run-"
+                        + std::to_string(device()) + '-';
+            }
+
+            external_sorter(external_sorter const&) = delete;
+            auto operator=(external_sorter const&) -> external_sorter& = delete;
+
+            ////////////////////////////////////////////////////////////
+            // Input
+
+            auto push(value_type const& value)
+                -> void
+            {
+                if (buffer_.size() == run_capacity_) {
+                    spill();
+                }
+                if (buffer_.capacity() == 0) {
+                    buffer_.reserve(run_capacity_);
+                }
+                buffer_.push_back(detail::get_twice_as_big(value));
+            }
+
+            auto sink() noexcept
+                -> sink_iterator
+            {
+                return sink_iterator(*this);
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Output
+
+            // Number of runs spilled to disk so far
+            auto run_count() const noexcept
+                -> std::size_t
+            {
+                return total_runs_;
+            }
+
+            // Write every pushed pair in sorted order to out, the
+            // sorter is empty afterwards
+            template<typename OutputIterator>
+            auto finish(OutputIterator out)
+                -> OutputIterator
+            {
+                if (runs_.empty()) {
+                    // Everything fits in memory
+                    std::sort(buffer_.begin(), buffer_.end());
+                    for (auto key: buffer_) {
+                        *out = detail::from_twice_as_big<T1>(key);
+                        ++out;
+                    }
+                    buffer_ = {};
+                    return out;
+                }
+
+                if (not buffer_.empty()) {
+                    spill();
+                }
+                buffer_ = {};
+
+                // Intermediate passes until the runs can all be merged
+                // with large enough read buffers
+                auto max_fan_in = std::max<std::size_t>(
+                    options_.memory_budget / min_read_buffer_bytes, 2
+                );
+                while (runs_.size() > max_fan_in) {
+                    std::vector<detail::sorted_run> next_runs;
+                    for (std::size_t first = 0 ; first < runs_.size() ; first += max_fan_in) {
+                        auto last = std::min(first + max_fan_in, runs_.size());
+                        next_runs.push_back(merge_to_run(first, last));
+                    }
+                    runs_ = std::move(next_runs);
+                }
+
+                merge(0, runs_.size(), [&out](key_type key) {
+                    *out = detail::from_twice_as_big<T1>(key);
+                    ++out;
+                });
+                runs_.clear();
+                return out;
+            }
+
+        private:
+
+            auto next_path()
+                -> std::string
+            {
+                return prefix_ + std::to_string(next_run_id_++) + ".bin";
+            }
+
+            auto write_run(key_type const* data, std::size_t size)
+                -> detail::sorted_run
+            {
+                detail::sorted_run run(next_path(), size);
+                detail::file_ptr file(std::fopen(run.path.c_str(), "wb"));
+                if (not file) {
+                    throw std::system_error(errno, std::generic_category(), run.path);
+                }
+                std::setvbuf(file.get(), nullptr, _IONBF, 0);
+                if (std::fwrite(data, sizeof(key_type), size, file.get()) != size) {
+                    throw std::system_error(errno, std::generic_category(), run.path);
+                }
+                if (std::fclose(file.release()) != 0) {
+                    throw std::system_error(errno, std::generic_category(), run.path);
+                }
+                return run;
+            }
+
+            auto spill()
+                -> void
+            {
+                std::sort(buffer_.begin(), buffer_.end());
+                runs_.push_back(write_run(buffer_.data(), buffer_.size()));
+                ++total_runs_;
+                buffer_.clear();
+            }
+
+            // When consume throws, the loser tree and the run readers are
+            // destroyed on the unwinding path, where GCC refuses to inline
+            // their destructors and reports it with -Winline
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Winline"
+#endif
+            template<typename Consumer>
+            auto merge(std::size_t first, std::size_t last, Consumer consume)
+                -> void
+            {
+                auto nb_runs = last - first;
+                auto buffer_size = options_.memory_budget / (nb_runs + 1) / sizeof(key_type);
+
+                std::vector<detail::run_reader<key_type>> readers;
+                readers.reserve(nb_runs);
+                loser_tree<key_type> tree(nb_runs);
+                for (std::size_t i = 0 ; i < nb_runs ; ++i) {
+                    readers.emplace_back(runs_[first + i], buffer_size);
+                    key_type key;
+                    if (readers.back().next(key)) {
+                        tree.set(i, key);
+                    }
+                }
+                tree.build();
+
+                while (not tree.empty()) {
+                    consume(tree.winner_key());
+                    key_type key;
+                    if (readers[tree.winner()].next(key)) {
+                        tree.replace_winner(key);
+                    } else {
+                        tree.winner_done();
+                    }
+                }
+            }
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+            auto merge_to_run(std::size_t first, std::size_t last)
+                -> detail::sorted_run
+            {
+                std::size_t size = 0;
+                for (auto i = first ; i < last ; ++i) {
+                    size += runs_[i].size;
+                }
+
+                detail::sorted_run run(next_path(), size);
+                detail::file_ptr file(std::fopen(run.path.c_str(), "wb"));
+                if (not file) {
+                    throw std::system_error(errno, std::generic_category(), run.path);
+                }
+
+                // Write through a buffer as big as a read buffer
+                std::vector<key_type> output;
+                output.reserve(options_.memory_budget / (last - first + 1) / sizeof(key_type) + 1);
+                auto flush = [&] {
+                    if (std::fwrite(output.data(), sizeof(key_type), output.size(), file.get()) != output.size()) {
+                        throw std::system_error(errno, std::generic_category(), run.path);
+                    }
+                    output.clear();
+                };
+                merge(first, last, [&](key_type key) {
+                    output.push_back(key);
+                    if (output.size() == output.capacity()) {
+                        flush();
+                    }
+                });
+                flush();
+                if (std::fclose(file.release()) != 0) {
+                    throw std::system_error(errno, std::generic_category(), run.path);
+                }
+                return run;
+            }
+
+            external_sort_options options_;
+            std::size_t run_capacity_;
+            std::string prefix_;
+            std::size_t next_run_id_ = 0;
+            std::size_t total_runs_ = 0;
+            std::vector<key_type> buffer_;
+            std::vector<detail::sorted_run> runs_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_EXTERNAL_SORT_H_
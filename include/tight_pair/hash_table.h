@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_HASH_TABLE_H_
+#define CRUFT_TIGHT_PAIR_HASH_TABLE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../tight_pair.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // 64-bit mixing function: every bit of the input affects
+        // every bit of the output
+
+        constexpr auto mix_hash(std::uint64_t word) noexcept
+            -> std::uint64_t
+        {
+            word ^= word >> 32;
+            word *= 0xd6e8feb86659fd93u;
+            word ^= word >> 32;
+            word *= 0xd6e8feb86659fd93u;
+            word ^= word >> 32;
+            return word;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Default hash function for packable pairs: the packed integer
+    // representation goes through a 64-bit mixing function, both
+    // halves of 128-bit representations are mixed in turn
+
+    struct pair_hash
+    {
+        template<typename T1, typename T2>
+        auto operator()(tight_pair<T1, T2> const& value) const noexcept
+            -> std::size_t
+        {
+            auto packed = detail::get_twice_as_big(value);
+            if constexpr (sizeof(packed) > sizeof(std::uint64_t)) {
+                auto low = static_cast<std::uint64_t>(packed);
+                auto high = static_cast<std::uint64_t>(packed >> 64);
+                return detail::mix_hash(high ^ detail::mix_hash(low));
+            } else {
+                return detail::mix_hash(packed);
+            }
+        }
+    };
+
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Control bytes: every slot of the table has a control byte
+        // telling whether it is empty, deleted, or full, in which
+        // case it holds the 7 low bits of the hash of the key
+
+        constexpr std::uint8_t ctrl_empty = 0x80;
+        constexpr std::uint8_t ctrl_deleted = 0xfe;
+
+        ////////////////////////////////////////////////////////////
+        // Groups of slots: the 8 control bytes of a group are loaded
+        // into a 64-bit word and matched at once with SWAR
+        // operations. A group only has 7 slots so that with 64-bit
+        // keys the control bytes and the keys fill a cache line, the
+        // last control byte is always marked deleted and ignored
+
+        constexpr std::size_t group_slots = 7;
+        constexpr std::uint64_t group_lsbs = 0x0101010101010101u;
+        constexpr std::uint64_t group_msbs = 0x0080808080808080u;
+
+        inline auto lowest_byte_index(std::uint64_t mask) noexcept
+            -> std::size_t
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_ctzll(mask)) / 8;
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanForward64(&index, mask);
+            return index / 8;
+#else
+            std::size_t index = 0;
+            while ((mask & 0xff) == 0) {
+                mask >>= 8;
+                ++index;
+            }
+            return index;
+#endif
+        }
+
+        template<typename Key>
+        struct alignas(sizeof(Key) == 8 ? 64 : alignof(Key)) slot_group
+        {
+            std::uint8_t ctrl[group_slots + 1] = {
+                ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+                ctrl_empty, ctrl_empty, ctrl_empty, ctrl_deleted
+            };
+            Key keys[group_slots] = {};
+
+            auto ctrl_word() const noexcept
+                -> std::uint64_t
+            {
+                // Byte i of the group always lands in byte i of the
+                // word, compilers turn this into a single load
+                std::uint64_t word = 0;
+                for (std::size_t i = 0 ; i < group_slots + 1 ; ++i) {
+                    word |= std::uint64_t(ctrl[i]) << (8 * i);
+                }
+                return word;
+            }
+
+            // May report false positives, which are discarded when
+            // comparing the keys
+            auto match(std::uint8_t h2) const noexcept
+                -> std::uint64_t
+            {
+                auto x = ctrl_word() ^ (group_lsbs * h2);
+                return (x - group_lsbs) & ~x & group_msbs;
+            }
+
+            auto match_empty() const noexcept
+                -> std::uint64_t
+            {
+                // Only empty bytes have their high bit set and the
+                // second lowest bit unset
+                auto word = ctrl_word();
+                return word & ~(word << 6) & group_msbs;
+            }
+
+            auto match_empty_or_deleted() const noexcept
+                -> std::uint64_t
+            {
+                return ctrl_word() & group_msbs;
+            }
+        };
+
+        struct no_mapped_value {};
+
+        ////////////////////////////////////////////////////////////
+        // Open-addressing table storing packed keys in groups next
+        // to their control bytes, with optional mapped values stored
+        // in a parallel array
+
+        template<typename T1, typename T2, typename Mapped, typename Hash>
+        class flat_pair_table
+        {
+            static_assert(std::is_same_v<T1, T2> && can_optimize_compare<T1>::value,
+                          "pair hash tables only support pairs that can be represented "
+                          "by a packed integer");
+
+            protected:
+
+                static constexpr bool has_values = not std::is_void_v<Mapped>;
+
+                using key_word = decltype(twice_as_big<T1>());
+                using group_type = slot_group<key_word>;
+                using mapped_storage = std::conditional_t<has_values, Mapped, no_mapped_value>;
+
+                static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+                static constexpr std::size_t min_groups = 2;
+
+            public:
+
+                ////////////////////////////////////////////////////////////
+                // Member types
+
+                using key_type = tight_pair<T1, T2>;
+                using size_type = std::size_t;
+                using hasher = Hash;
+
+                ////////////////////////////////////////////////////////////
+                // Construction
+
+                flat_pair_table() = default;
+
+                explicit flat_pair_table(Hash hash):
+                    hash_(std::move(hash))
+                {}
+
+                ////////////////////////////////////////////////////////////
+                // Capacity
+
+                auto empty() const noexcept
+                    -> bool
+                {
+                    return size_ == 0;
+                }
+
+                auto size() const noexcept
+                    -> size_type
+                {
+                    return size_;
+                }
+
+                auto capacity() const noexcept
+                    -> size_type
+                {
+                    return groups_.size() * group_slots;
+                }
+
+                auto reserve(size_type count)
+                    -> void
+                {
+                    auto nb_groups = groups_for(count);
+                    if (nb_groups > groups_.size()) {
+                        rehash(nb_groups);
+                    }
+                }
+
+                auto clear() noexcept
+                    -> void
+                {
+                    groups_.clear();
+                    values_.clear();
+                    size_ = 0;
+                    growth_left_ = 0;
+                }
+
+                ////////////////////////////////////////////////////////////
+                // Lookup
+
+                auto contains(key_type const& key) const
+                    -> bool
+                {
+                    return find_slot(key) != npos;
+                }
+
+                ////////////////////////////////////////////////////////////
+                // Modifiers
+
+                auto erase(key_type const& key)
+                    -> bool
+                {
+                    auto slot = find_slot(key);
+                    if (slot == npos) {
+                        return false;
+                    }
+                    if constexpr (has_values) {
+                        values_[slot] = Mapped();
+                    }
+                    // Probe sequences stop at a group with an empty slot,
+                    // so the slot can be marked empty if its group already
+                    // has one: no probe sequence went past this group
+                    auto& group = groups_[slot / group_slots];
+                    if (group.match_empty()) {
+                        group.ctrl[slot % group_slots] = ctrl_empty;
+                        ++growth_left_;
+                    } else {
+                        group.ctrl[slot % group_slots] = ctrl_deleted;
+                    }
+                    --size_;
+                    return true;
+                }
+
+            protected:
+
+                static constexpr auto groups_for(size_type count) noexcept
+                    -> size_type
+                {
+                    // Maximal load factor of 7/8
+                    size_type nb_groups = min_groups;
+                    while (max_load(nb_groups) < count) {
+                        nb_groups *= 2;
+                    }
+                    return nb_groups;
+                }
+
+                static constexpr auto max_load(size_type nb_groups) noexcept
+                    -> size_type
+                {
+                    auto capacity = nb_groups * group_slots;
+                    return capacity - capacity / 8;
+                }
+
+                auto hash(key_type const& key) const
+                    -> std::size_t
+                {
+                    return static_cast<std::size_t>(hash_(key));
+                }
+
+                // Quadratic probing over groups: with a power of two
+                // number of groups, every group is visited once
+                template<typename Function>
+                auto probe(std::size_t hash, Function func) const
+                    -> std::size_t
+                {
+                    auto mask = groups_.size() - 1;
+                    auto group = (hash >> 7) & mask;
+                    for (std::size_t step = 1 ; ; ++step) {
+                        auto res = func(group);
+                        if (res != npos) {
+                            return res;
+                        }
+                        group = (group + step) & mask;
+                    }
+                }
+
+                auto find_slot(key_type const& key) const
+                    -> std::size_t
+                {
+                    if (groups_.empty()) {
+                        return npos;
+                    }
+                    auto key_hash = hash(key);
+                    auto h2 = static_cast<std::uint8_t>(key_hash & 0x7f);
+                    key_word word = get_twice_as_big(key);
+                    std::size_t found = npos;
+
+                    probe(key_hash, [&](std::size_t index) {
+                        auto& group = groups_[index];
+                        for (auto match = group.match(h2) ; match ; match &= match - 1) {
+                            auto i = lowest_byte_index(match);
+                            if (group.keys[i] == word) {
+                                found = index * group_slots + i;
+                                return found;
+                            }
+                        }
+                        // Stop at the first group with an empty slot
+                        return group.match_empty() ? index : npos;
+                    });
+                    return found;
+                }
+
+                // Slot of the key, inserted if it wasn't already in the
+                // table; the boolean tells whether it was inserted
+                auto find_or_prepare_insert(key_type const& key)
+                    -> std::pair<std::size_t, bool>
+                {
+                    if (groups_.empty()) {
+                        rehash(min_groups);
+                    }
+                    auto key_hash = hash(key);
+                    auto h2 = static_cast<std::uint8_t>(key_hash & 0x7f);
+                    key_word word = get_twice_as_big(key);
+
+                    // First slot available for insertion along the probe
+                    // sequence, deleted slots can be reused
+                    std::size_t available = npos;
+                    std::size_t found = npos;
+                    probe(key_hash, [&](std::size_t index) {
+                        auto& group = groups_[index];
+                        for (auto match = group.match(h2) ; match ; match &= match - 1) {
+                            auto i = lowest_byte_index(match);
+                            if (group.keys[i] == word) {
+                                found = index * group_slots + i;
+                                return found;
+                            }
+                        }
+                        if (available == npos) {
+                            if (auto free = group.match_empty_or_deleted()) {
+                                available = index * group_slots + lowest_byte_index(free);
+                            }
+                        }
+                        return group.match_empty() ? index : npos;
+                    });
+                    if (found != npos) {
+                        return { found, false };
+                    }
+
+                    auto& group = groups_[available / group_slots];
+                    auto i = available % group_slots;
+                    if (group.ctrl[i] == ctrl_empty) {
+                        if (growth_left_ == 0) {
+                            rehash(groups_for(2 * (size_ + 1)));
+                            auto slot = insert_after_rehash(key_hash, h2, word);
+                            --growth_left_;
+                            ++size_;
+                            return { slot, true };
+                        }
+                        --growth_left_;
+                    }
+                    group.ctrl[i] = h2;
+                    group.keys[i] = word;
+                    ++size_;
+                    return { available, true };
+                }
+
+                auto rehash(size_type nb_groups)
+                    -> void
+                {
+                    auto old_groups = std::move(groups_);
+                    auto old_values = std::move(values_);
+
+                    groups_.assign(nb_groups, group_type{});
+                    values_ = {};
+                    if constexpr (has_values) {
+                        values_.resize(nb_groups * group_slots);
+                    }
+                    growth_left_ = max_load(nb_groups) - size_;
+
+                    for (std::size_t index = 0 ; index < old_groups.size() ; ++index) {
+                        auto const& group = old_groups[index];
+                        for (std::size_t i = 0 ; i < group_slots ; ++i) {
+                            if (group.ctrl[i] & 0x80) {
+                                continue;
+                            }
+                            auto key_hash = hash(from_twice_as_big<T1>(group.keys[i]));
+                            auto slot = insert_after_rehash(key_hash, group.ctrl[i], group.keys[i]);
+                            if constexpr (has_values) {
+                                values_[slot] = std::move(old_values[index * group_slots + i]);
+                            }
+                        }
+                    }
+                }
+
+                template<typename Function>
+                auto for_each_slot(Function func) const
+                    -> void
+                {
+                    for (std::size_t index = 0 ; index < groups_.size() ; ++index) {
+                        auto const& group = groups_[index];
+                        for (std::size_t i = 0 ; i < group_slots ; ++i) {
+                            if (not (group.ctrl[i] & 0x80)) {
+                                func(index * group_slots + i, from_twice_as_big<T1>(group.keys[i]));
+                            }
+                        }
+                    }
+                }
+
+                std::vector<group_type> groups_;
+                std::vector<mapped_storage> values_;
+                size_type size_ = 0;
+                size_type growth_left_ = 0;
+                Hash hash_;
+
+            private:
+
+                // Insertion of a key known not to be in a table without
+                // deleted slots: only the first empty slot is needed
+                auto insert_after_rehash(std::size_t key_hash, std::uint8_t h2, key_word word)
+                    -> std::size_t
+                {
+                    auto slot = probe(key_hash, [&](std::size_t index) {
+                        auto free = groups_[index].match_empty();
+                        return free ? index * group_slots + lowest_byte_index(free) : npos;
+                    });
+                    auto& group = groups_[slot / group_slots];
+                    group.ctrl[slot % group_slots] = h2;
+                    group.keys[slot % group_slots] = word;
+                    return slot;
+                }
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Hash set of packable pairs
+    //
+    // Swiss table-like open-addressing table: keys are stored as
+    // packed integers in groups of 7 next to a word of control
+    // bytes holding 7 bits of the hash of every key, which lets
+    // the table probe a whole group with a few integer operations
+    // and, for 64-bit keys, a single cache line
+
+    template<typename T1, typename T2, typename Hash=pair_hash>
+    class pair_hash_set:
+        public detail::flat_pair_table<T1, T2, void, Hash>
+    {
+        using base = detail::flat_pair_table<T1, T2, void, Hash>;
+
+        public:
+
+            using value_type = typename base::key_type;
+
+            using base::base;
+
+            // Returns whether the value was inserted
+            auto insert(value_type const& value)
+                -> bool
+            {
+                return this->find_or_prepare_insert(value).second;
+            }
+
+            // Calls func on every element, in unspecified order
+            template<typename Function>
+            auto for_each(Function func) const
+                -> void
+            {
+                this->for_each_slot([&func](std::size_t, value_type const& value) {
+                    func(value);
+                });
+            }
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Hash map whose keys are packable pairs, with the same layout
+    // as pair_hash_set plus a flat array of mapped values, which
+    // must be default-constructible
+
+    template<typename T1, typename T2, typename Mapped, typename Hash=pair_hash>
+    class pair_hash_map:
+        public detail::flat_pair_table<T1, T2, Mapped, Hash>
+    {
+        using base = detail::flat_pair_table<T1, T2, Mapped, Hash>;
+
+        static_assert(std::is_default_constructible_v<Mapped>,
+                      "the mapped type of a pair_hash_map must be default-constructible");
+
+        public:
+
+            using key_type = typename base::key_type;
+            using mapped_type = Mapped;
+
+            using base::base;
+
+            // Returns whether the key was inserted, the mapped value of
+            // an existing key is left untouched
+            template<typename M>
+            auto insert(key_type const& key, M&& value)
+                -> bool
+            {
+                auto [slot, inserted] = this->find_or_prepare_insert(key);
+                if (inserted) {
+                    this->values_[slot] = std::forward<M>(value);
+                }
+                return inserted;
+            }
+
+            template<typename M>
+            auto insert_or_assign(key_type const& key, M&& value)
+                -> bool
+            {
+                auto [slot, inserted] = this->find_or_prepare_insert(key);
+                this->values_[slot] = std::forward<M>(value);
+                return inserted;
+            }
+
+            auto operator[](key_type const& key)
+                -> Mapped&
+            {
+                return this->values_[this->find_or_prepare_insert(key).first];
+            }
+
+            // Pointer to the mapped value, or nullptr if the key isn't
+            // in the map; invalidated by insertions
+            auto find(key_type const& key)
+                -> Mapped*
+            {
+                auto slot = this->find_slot(key);
+                return slot == base::npos ? nullptr : &this->values_[slot];
+            }
+
+            auto find(key_type const& key) const
+                -> Mapped const*
+            {
+                auto slot = this->find_slot(key);
+                return slot == base::npos ? nullptr : &this->values_[slot];
+            }
+
+            // Calls func(key, value) on every element, in unspecified order
+            template<typename Function>
+            auto for_each(Function func)
+                -> void
+            {
+                this->for_each_slot([&](std::size_t slot, key_type const& key) {
+                    func(key, this->values_[slot]);
+                });
+            }
+
+            template<typename Function>
+            auto for_each(Function func) const
+                -> void
+            {
+                this->for_each_slot([&](std::size_t slot, key_type const& key) {
+                    func(key, this->values_[slot]);
+                });
+            }
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_HASH_TABLE_H_
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_KWAY_MERGE_H_
+#define CRUFT_TIGHT_PAIR_KWAY_MERGE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "detail/packed_key.h"
+#include "loser_tree.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Merge any number of sorted ranges into out, the merge is
+    // stable: equivalent elements are written in the order of
+    // the ranges they come from
+    //
+    // When merging tight_pair<T, T> with std::less or std::greater
+    // and the pair comparison can use the packed representation,
+    // the loser tree stores and compares packed integers
+
+    template<typename Ranges, typename OutputIterator, typename Compare=std::less<>>
+    auto kway_merge(Ranges&& ranges, OutputIterator out, Compare compare={})
+        -> OutputIterator
+    {
+        using std::begin;
+        using std::end;
+        using range_type = std::remove_reference_t<decltype(*begin(ranges))>;
+        using iterator = decltype(begin(std::declval<range_type&>()));
+        using value_type = typename std::iterator_traits<iterator>::value_type;
+        using adapter = detail::packed_key_adapter<value_type, Compare>;
+
+        std::vector<std::pair<iterator, iterator>> cursors;
+        for (auto&& range: ranges) {
+            cursors.emplace_back(begin(range), end(range));
+        }
+
+        loser_tree<typename adapter::key_type, typename adapter::compare_type> tree(
+            cursors.size(), adapter::compare(compare)
+        );
+        for (std::size_t i = 0 ; i < cursors.size() ; ++i) {
+            if (cursors[i].first != cursors[i].second) {
+                tree.set(i, adapter::to_key(*cursors[i].first));
+            }
+        }
+        tree.build();
+
+        while (not tree.empty()) {
+            auto& cursor = cursors[tree.winner()];
+            *out = *cursor.first;
+            ++out;
+            if (++cursor.first != cursor.second) {
+                tree.replace_winner(adapter::to_key(*cursor.first));
+            } else {
+                tree.winner_done();
+            }
+        }
+        return out;
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_KWAY_MERGE_H_
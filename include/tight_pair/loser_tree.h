@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_LOSER_TREE_H_
+#define CRUFT_TIGHT_PAIR_LOSER_TREE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Tournament tree of losers used to merge sorted sources:
+    // the keys are stored contiguously in the nodes of the tree,
+    // exhausted sources compare greater than every key, and ties
+    // are broken by source index, which makes merges stable
+    //
+    // Replacing the key of the winner and replaying the matches
+    // from its leaf to the root costs log2(k) matches, which are
+    // written without short-circuiting operators to avoid branches
+    //
+    // Key must be default-constructible
+
+    template<typename Key, typename Compare=std::less<>>
+    class loser_tree
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit loser_tree(std::size_t nb_sources, Compare compare={}):
+                compare_(std::move(compare))
+            {
+                // Round the number of leaves up to a power of 2, the
+                // additional leaves are exhausted sources
+                leaves_ = 1;
+                while (leaves_ < nb_sources) {
+                    leaves_ *= 2;
+                }
+                keys_.resize(2 * leaves_);
+                sources_.resize(2 * leaves_);
+                for (std::size_t i = 0 ; i < leaves_ ; ++i) {
+                    sources_[leaves_ + i] = static_cast<std::uint32_t>(i) | done_bit;
+                }
+            }
+
+            // Set the initial key of a source, call build() once
+            // all the non-exhausted sources have a key
+            auto set(std::size_t source, Key key)
+                -> void
+            {
+                keys_[leaves_ + source] = std::move(key);
+                sources_[leaves_ + source] = static_cast<std::uint32_t>(source);
+            }
+
+            auto build()
+                -> void
+            {
+                // Index 0 holds the overall winner, index i holds the
+                // loser of the match played at internal node i, the
+                // second half only holds the leaves during the build
+                auto winner = build_subtree(1);
+                keys_[0] = keys_[winner];
+                sources_[0] = sources_[winner];
+                keys_.resize(leaves_);
+                sources_.resize(leaves_);
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Winner access
+
+            auto empty() const noexcept
+                -> bool
+            {
+                return sources_[0] & done_bit;
+            }
+
+            auto winner() const noexcept
+                -> std::size_t
+            {
+                return sources_[0] & ~done_bit;
+            }
+
+            auto winner_key() const noexcept
+                -> Key const&
+            {
+                return keys_[0];
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Update the winner and replay its matches
+
+            auto replace_winner(Key key)
+                -> void
+            {
+                keys_[0] = std::move(key);
+                replay();
+            }
+
+            auto winner_done()
+                -> void
+            {
+                sources_[0] |= done_bit;
+                replay();
+            }
+
+        private:
+
+            // The keys are stored in the nodes of the tree next to the
+            // index of their source, whose most significant bit is set
+            // when the source is exhausted
+            static constexpr std::uint32_t done_bit = std::uint32_t(1) << 31;
+
+            auto beats(Key const& lhs_key, std::uint32_t lhs_source,
+                       Key const& rhs_key, std::uint32_t rhs_source) const
+                -> bool
+            {
+                // Exhausted sources lose every match, and since the
+                // done bit is the most significant one, comparing the
+                // sources breaks ties between keys, the non-short
+                // circuiting operators avoid branches
+                bool keys_less = compare_(lhs_key, rhs_key);
+                bool keys_greater = compare_(rhs_key, lhs_key);
+                bool lhs_done = lhs_source & done_bit;
+                bool rhs_done = rhs_source & done_bit;
+                bool wins = keys_less | ((not keys_greater) & (lhs_source < rhs_source));
+                return (not lhs_done) & (rhs_done | wins);
+            }
+
+            auto build_subtree(std::size_t index)
+                -> std::size_t
+            {
+                if (index >= leaves_) {
+                    return index;
+                }
+                auto left = build_subtree(2 * index);
+                auto right = build_subtree(2 * index + 1);
+                if (beats(keys_[right], sources_[right], keys_[left], sources_[left])) {
+                    std::swap(left, right);
+                }
+                keys_[index] = keys_[right];
+                sources_[index] = sources_[right];
+                return left;
+            }
+
+            auto replay()
+                -> void
+            {
+                auto winner_key = std::move(keys_[0]);
+                auto winner_source = sources_[0];
+                auto index = ((winner_source & ~done_bit) + leaves_) / 2;
+                for (; index > 0 ; index /= 2) {
+                    // Conditional moves instead of swaps
+                    bool swap = beats(keys_[index], sources_[index], winner_key, winner_source);
+                    auto loser_source = sources_[index];
+                    sources_[index] = swap ? winner_source : loser_source;
+                    winner_source = swap ? loser_source : winner_source;
+                    if constexpr (std::is_scalar_v<Key>) {
+                        auto loser_key = keys_[index];
+                        keys_[index] = swap ? winner_key : loser_key;
+                        winner_key = swap ? loser_key : winner_key;
+                    } else {
+                        if (swap) {
+                            using std::swap;
+                            swap(keys_[index], winner_key);
+                        }
+                    }
+                }
+                keys_[0] = std::move(winner_key);
+                sources_[0] = winner_source;
+            }
+
+            std::vector<Key> keys_;
+            std::vector<std::uint32_t> sources_;
+            std::size_t leaves_;
+            Compare compare_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_LOSER_TREE_H_
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_MAPPED_PAIR_TABLE_H_
+#define CRUFT_TIGHT_PAIR_MAPPED_PAIR_TABLE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include "serialization.h"
+
+#ifdef _WIN32
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Read-only table of pairs memory-mapped from a file in the
+    // canonical format described in <tight_pair/serialization.h>:
+    // nothing is deserialized when opening the table, the pairs
+    // are decoded on access
+
+    template<typename T1, typename T2>
+    class mapped_pair_table:
+        public pair_table_view<T1, T2>
+    {
+        private:
+
+            using view_type = pair_table_view<T1, T2>;
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit mapped_pair_table(std::string const& path)
+            {
+                auto bytes = map_file(path.c_str());
+                if (bytes % view_type::record_size != 0) {
+                    unmap();
+                    throw std::runtime_error(
+                        "the size of " + path + " is not a multiple of the size of a record"
+                    );
+                }
+                static_cast<view_type&>(*this) = view_type(mapping_, bytes);
+            }
+
+            mapped_pair_table(mapped_pair_table const&) = delete;
+            auto operator=(mapped_pair_table const&) -> mapped_pair_table& = delete;
+
+            mapped_pair_table(mapped_pair_table&& other) noexcept:
+                view_type(std::exchange(static_cast<view_type&>(other), view_type())),
+                mapping_(std::exchange(other.mapping_, nullptr)),
+                mapped_bytes_(std::exchange(other.mapped_bytes_, 0))
+            {}
+
+            auto operator=(mapped_pair_table&& other) noexcept
+                -> mapped_pair_table&
+            {
+                if (this != &other) {
+                    unmap();
+                    static_cast<view_type&>(*this) = std::exchange(static_cast<view_type&>(other), view_type());
+                    mapping_ = std::exchange(other.mapping_, nullptr);
+                    mapped_bytes_ = std::exchange(other.mapped_bytes_, 0);
+                }
+                return *this;
+            }
+
+            ~mapped_pair_table()
+            {
+                unmap();
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Access to the underlying view
+
+            auto view() const noexcept
+                -> view_type
+            {
+                return *this;
+            }
+
+        private:
+
+            auto map_file(char const* path)
+                -> std::size_t
+            {
+#ifdef _WIN32
+                HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) {
+                    throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), path);
+                }
+
+                LARGE_INTEGER file_size;
+                if (not GetFileSizeEx(file, &file_size)) {
+                    auto error = GetLastError();
+                    CloseHandle(file);
+                    throw std::system_error(static_cast<int>(error), std::system_category(), path);
+                }
+                if (file_size.QuadPart == 0) {
+                    CloseHandle(file);
+                    return 0;
+                }
+
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                auto error = GetLastError();
+                CloseHandle(file);
+                if (mapping == nullptr) {
+                    throw std::system_error(static_cast<int>(error), std::system_category(), path);
+                }
+
+                void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                error = GetLastError();
+                CloseHandle(mapping);
+                if (addr == nullptr) {
+                    throw std::system_error(static_cast<int>(error), std::system_category(), path);
+                }
+                auto size = file_size.QuadPart;
+#else
+                int fd = ::open(path, O_RDONLY);
+                if (fd == -1) {
+                    throw std::system_error(errno, std::generic_category(), path);
+                }
+
+                struct stat infos;
+                if (::fstat(fd, &infos) == -1) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), path);
+                }
+                if (infos.st_size == 0) {
+                    ::close(fd);
+                    return 0;
+                }
+
+                void* addr = ::mmap(nullptr, static_cast<std::size_t>(infos.st_size),
+                                    PROT_READ, MAP_SHARED, fd, 0);
+                int error = errno;
+                ::close(fd);
+                if (addr == MAP_FAILED) {
+                    throw std::system_error(error, std::generic_category(), path);
+                }
+                auto size = infos.st_size;
+#endif
+                mapping_ = static_cast<unsigned char const*>(addr);
+                mapped_bytes_ = static_cast<std::size_t>(size);
+                return mapped_bytes_;
+            }
+
+            auto unmap() noexcept
+                -> void
+            {
+                if (mapping_ == nullptr) {
+                    return;
+                }
+#ifdef _WIN32
+                UnmapViewOfFile(mapping_);
+#else
+                ::munmap(const_cast<unsigned char*>(mapping_), mapped_bytes_);
+#endif
+                mapping_ = nullptr;
+                mapped_bytes_ = 0;
+            }
+
+            unsigned char const* mapping_ = nullptr;
+            std::size_t mapped_bytes_ = 0;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_MAPPED_PAIR_TABLE_H_
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_MERGE_H_
+#define CRUFT_TIGHT_PAIR_MERGE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Dispatch helpers
+
+        template<typename Iterator>
+        constexpr bool is_random_access_v = std::is_base_of_v<
+            std::random_access_iterator_tag,
+            typename std::iterator_traits<Iterator>::iterator_category
+        >;
+
+        template<typename Iterator1, typename Iterator2>
+        constexpr bool can_use_branchless_merge_v =
+            is_random_access_v<Iterator1> &&
+            is_random_access_v<Iterator2> &&
+            std::is_same_v<
+                typename std::iterator_traits<Iterator1>::value_type,
+                typename std::iterator_traits<Iterator2>::value_type
+            >;
+
+        // Compares elements through their packed keys when possible
+        template<typename T, typename Compare>
+        struct key_less
+        {
+            using adapter = packed_key_adapter<T, Compare>;
+
+            typename adapter::compare_type compare;
+
+            constexpr auto operator()(T const& lhs, T const& rhs) const
+                -> bool
+            {
+                return compare(adapter::to_key(lhs), adapter::to_key(rhs));
+            }
+        };
+
+        template<typename T, typename Compare>
+        constexpr auto make_key_less(Compare const& compare)
+            -> key_less<T, Compare>
+        {
+            return { packed_key_adapter<T, Compare>::compare(compare) };
+        }
+
+        // Ratios between the sizes of two ranges: under the first
+        // one the comparisons are unpredictable and the branchless
+        // loops win, above the second one it is cheaper to search
+        // the elements of the smaller range in the bigger one with
+        // galloping, and in between the branches of the standard
+        // algorithms are well predicted
+        constexpr std::size_t branchless_ratio = 4;
+        constexpr std::size_t gallop_ratio = 32;
+
+        enum struct skew
+        {
+            none,
+            moderate,
+            first_smaller,
+            second_smaller
+        };
+
+        template<typename Iterator1, typename Iterator2>
+        constexpr auto get_skew(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
+            -> skew
+        {
+            auto size1 = static_cast<std::size_t>(last1 - first1);
+            auto size2 = static_cast<std::size_t>(last2 - first2);
+            if (size1 / gallop_ratio > size2) return skew::second_smaller;
+            if (size2 / gallop_ratio > size1) return skew::first_smaller;
+            if (size1 / branchless_ratio > size2 || size2 / branchless_ratio > size1) {
+                return skew::moderate;
+            }
+            return skew::none;
+        }
+
+        // Number of packed keys accumulated before being written to
+        // the output iterator: keys are stored unconditionally in the
+        // buffer and only the buffer cursor depends on comparisons
+        constexpr std::size_t output_buffer_size = 256;
+
+        template<typename Adapter, typename Key, typename OutputIterator>
+        auto flush_keys(Key const* buffer, std::size_t size, OutputIterator out)
+            -> OutputIterator
+        {
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                *out = Adapter::from_key(buffer[i]);
+                ++out;
+            }
+            return out;
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Exponential search followed by a branchless binary search,
+        // finds the first element for which less(element, value) is
+        // false, cheap when it is close to first
+
+        template<typename RandomAccessIterator, typename T, typename Less>
+        constexpr auto gallop_lower_bound(RandomAccessIterator first, RandomAccessIterator last,
+                                          T const& value, Less less)
+            -> RandomAccessIterator
+        {
+            using difference_type = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+            difference_type size = last - first;
+            if (size == 0 || not less(first[0], value)) {
+                return first;
+            }
+
+            // Invariant: less(first[bound / 2], value) holds
+            difference_type bound = 1;
+            while (bound < size && less(first[bound], value)) {
+                bound *= 2;
+            }
+
+            first += bound / 2 + 1;
+            difference_type len = std::min(bound, size) - (bound / 2 + 1);
+            while (len > 0) {
+                difference_type half = len / 2;
+                bool go_right = less(first[half], value);
+                first = go_right ? first + half + 1 : first;
+                len = go_right ? len - half - 1 : half;
+            }
+            return first;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Merge two sorted ranges, equivalent to std::merge
+    //
+    // With random-access iterators over packable pairs compared
+    // with std::less or std::greater, the elements are compared as
+    // packed integers and the cursors advance without branches
+
+    template<
+        typename InputIterator1,
+        typename InputIterator2,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    auto merge(InputIterator1 first1, InputIterator1 last1,
+               InputIterator2 first2, InputIterator2 last2,
+               OutputIterator out, Compare compare={})
+        -> OutputIterator
+    {
+        if constexpr (detail::can_use_branchless_merge_v<InputIterator1, InputIterator2>) {
+            using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+            using adapter = detail::packed_key_adapter<value_type, Compare>;
+
+            // Merging copies every element anyway: galloping doesn't
+            // save any work and skewed inputs are well predicted
+            if (detail::get_skew(first1, last1, first2, last2) != detail::skew::none) {
+                return std::merge(first1, last1, first2, last2, out, std::move(compare));
+            }
+
+            if constexpr (adapter::is_packed) {
+                auto key_compare = adapter::compare(compare);
+                while (first1 != last1 && first2 != last2) {
+                    auto key1 = adapter::to_key(*first1);
+                    auto key2 = adapter::to_key(*first2);
+                    bool take2 = key_compare(key2, key1);
+                    *out = adapter::from_key(take2 ? key2 : key1);
+                    ++out;
+                    first1 += not take2;
+                    first2 += take2;
+                }
+            } else {
+                while (first1 != last1 && first2 != last2) {
+                    bool take2 = compare(*first2, *first1);
+                    *out = take2 ? *first2 : *first1;
+                    ++out;
+                    first1 += not take2;
+                    first2 += take2;
+                }
+            }
+            out = std::copy(first1, last1, out);
+            return std::copy(first2, last2, out);
+        } else {
+            return std::merge(first1, last1, first2, last2, out, std::move(compare));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Intersection of two sorted ranges, equivalent to
+    // std::set_intersection
+    //
+    // Packed keys are accumulated in a small buffer so that the
+    // main loop has no branch depending on comparisons, and the
+    // elements of a much smaller range are searched in the bigger
+    // one with galloping
+
+    template<
+        typename InputIterator1,
+        typename InputIterator2,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    auto set_intersection(InputIterator1 first1, InputIterator1 last1,
+                          InputIterator2 first2, InputIterator2 last2,
+                          OutputIterator out, Compare compare={})
+        -> OutputIterator
+    {
+        if constexpr (detail::can_use_branchless_merge_v<InputIterator1, InputIterator2>) {
+            using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+            using adapter = detail::packed_key_adapter<value_type, Compare>;
+            auto less = detail::make_key_less<value_type>(compare);
+
+            switch (detail::get_skew(first1, last1, first2, last2)) {
+                case detail::skew::first_smaller:
+                    for (; first1 != last1 ; ++first1) {
+                        first2 = detail::gallop_lower_bound(first2, last2, *first1, less);
+                        if (first2 == last2) break;
+                        if (not less(*first1, *first2)) {
+                            *out = *first1;
+                            ++out;
+                            ++first2;
+                        }
+                    }
+                    return out;
+                case detail::skew::second_smaller:
+                    for (; first2 != last2 ; ++first2) {
+                        first1 = detail::gallop_lower_bound(first1, last1, *first2, less);
+                        if (first1 == last1) break;
+                        if (not less(*first2, *first1)) {
+                            *out = *first1;
+                            ++out;
+                            ++first1;
+                        }
+                    }
+                    return out;
+                case detail::skew::moderate:
+                    return std::set_intersection(first1, last1, first2, last2, out, std::move(compare));
+                case detail::skew::none:
+                    break;
+            }
+
+            if constexpr (adapter::is_packed) {
+                auto key_compare = adapter::compare(compare);
+                typename adapter::key_type buffer[detail::output_buffer_size];
+                std::size_t size = 0;
+                while (first1 != last1 && first2 != last2) {
+                    auto key1 = adapter::to_key(*first1);
+                    auto key2 = adapter::to_key(*first2);
+                    bool less1 = key_compare(key1, key2);
+                    bool less2 = key_compare(key2, key1);
+                    buffer[size] = key1;
+                    size += not (less1 || less2);
+                    first1 += not less2;
+                    first2 += not less1;
+                    if (size == detail::output_buffer_size) {
+                        out = detail::flush_keys<adapter>(buffer, size, out);
+                        size = 0;
+                    }
+                }
+                return detail::flush_keys<adapter>(buffer, size, out);
+            } else {
+                while (first1 != last1 && first2 != last2) {
+                    bool less1 = less(*first1, *first2);
+                    bool less2 = less(*first2, *first1);
+                    if (not (less1 || less2)) {
+                        *out = *first1;
+                        ++out;
+                    }
+                    first1 += not less2;
+                    first2 += not less1;
+                }
+                return out;
+            }
+        } else {
+            return std::set_intersection(first1, last1, first2, last2, out, std::move(compare));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Elements of the first sorted range that are not found in
+    // the second one, equivalent to std::set_difference
+
+    template<
+        typename InputIterator1,
+        typename InputIterator2,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    auto set_difference(InputIterator1 first1, InputIterator1 last1,
+                        InputIterator2 first2, InputIterator2 last2,
+                        OutputIterator out, Compare compare={})
+        -> OutputIterator
+    {
+        if constexpr (detail::can_use_branchless_merge_v<InputIterator1, InputIterator2>) {
+            using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+            using adapter = detail::packed_key_adapter<value_type, Compare>;
+            auto less = detail::make_key_less<value_type>(compare);
+
+            switch (detail::get_skew(first1, last1, first2, last2)) {
+                case detail::skew::first_smaller:
+                    for (; first1 != last1 ; ++first1) {
+                        first2 = detail::gallop_lower_bound(first2, last2, *first1, less);
+                        if (first2 != last2 && not less(*first1, *first2)) {
+                            ++first2;
+                        } else {
+                            *out = *first1;
+                            ++out;
+                        }
+                    }
+                    return out;
+                case detail::skew::second_smaller:
+                case detail::skew::moderate:
+                    // Most elements of the first range are copied
+                    return std::set_difference(first1, last1, first2, last2, out, std::move(compare));
+                case detail::skew::none:
+                    break;
+            }
+
+            if constexpr (adapter::is_packed) {
+                auto key_compare = adapter::compare(compare);
+                typename adapter::key_type buffer[detail::output_buffer_size];
+                std::size_t size = 0;
+                while (first1 != last1 && first2 != last2) {
+                    auto key1 = adapter::to_key(*first1);
+                    auto key2 = adapter::to_key(*first2);
+                    bool less1 = key_compare(key1, key2);
+                    bool less2 = key_compare(key2, key1);
+                    buffer[size] = key1;
+                    size += less1;
+                    first1 += not less2;
+                    first2 += not less1;
+                    if (size == detail::output_buffer_size) {
+                        out = detail::flush_keys<adapter>(buffer, size, out);
+                        size = 0;
+                    }
+                }
+                out = detail::flush_keys<adapter>(buffer, size, out);
+            } else {
+                while (first1 != last1 && first2 != last2) {
+                    bool less1 = less(*first1, *first2);
+                    bool less2 = less(*first2, *first1);
+                    if (less1) {
+                        *out = *first1;
+                        ++out;
+                    }
+                    first1 += not less2;
+                    first2 += not less1;
+                }
+            }
+            return std::copy(first1, last1, out);
+        } else {
+            return std::set_difference(first1, last1, first2, last2, out, std::move(compare));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Equi-join of two ranges of pairs sorted by their first
+    // element: callback is called with every pair of elements
+    // whose first elements are equivalent, and returned like
+    // std::for_each does
+    //
+    // Matches break the branch prediction of the lockstep walk
+    // either way, so only much smaller ranges get a dedicated
+    // treatment: their elements are searched with galloping
+
+    template<typename Range1, typename Range2, typename Callback>
+    auto merge_join_on_first(Range1&& left, Range2&& right, Callback callback)
+        -> Callback
+    {
+        using std::begin;
+        using std::end;
+        using cruft::get;
+
+        auto first1 = begin(left);
+        auto last1 = end(left);
+        auto first2 = begin(right);
+        auto last2 = end(right);
+
+        auto less = [](auto const& lhs, auto const& rhs) {
+            return get<0>(lhs) < get<0>(rhs);
+        };
+
+        constexpr bool random_access = detail::is_random_access_v<decltype(first1)>
+                                    && detail::is_random_access_v<decltype(first2)>;
+        auto skew = detail::skew::none;
+        if constexpr (random_access) {
+            skew = detail::get_skew(first1, last1, first2, last2);
+        }
+
+        while (first1 != last1 && first2 != last2) {
+            if constexpr (random_access) {
+                if (skew == detail::skew::first_smaller) {
+                    first2 = detail::gallop_lower_bound(first2, last2, *first1, less);
+                    if (first2 == last2) break;
+                } else if (skew == detail::skew::second_smaller) {
+                    first1 = detail::gallop_lower_bound(first1, last1, *first2, less);
+                    if (first1 == last1) break;
+                }
+            }
+
+            if (less(*first1, *first2)) {
+                ++first1;
+                continue;
+            }
+            if (less(*first2, *first1)) {
+                ++first2;
+                continue;
+            }
+
+            // Equivalent keys: call back on the cartesian product
+            // of both groups
+            auto group_end1 = std::next(first1);
+            while (group_end1 != last1 && not less(*first1, *group_end1)) {
+                ++group_end1;
+            }
+            auto group_end2 = std::next(first2);
+            while (group_end2 != last2 && not less(*first2, *group_end2)) {
+                ++group_end2;
+            }
+            for (auto it1 = first1 ; it1 != group_end1 ; ++it1) {
+                for (auto it2 = first2 ; it2 != group_end2 ; ++it2) {
+                    callback(*it1, *it2);
+                }
+            }
+            first1 = group_end1;
+            first2 = group_end2;
+        }
+        return callback;
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_MERGE_H_
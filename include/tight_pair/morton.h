@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_MORTON_H_
+#define CRUFT_TIGHT_PAIR_MORTON_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+#include "../tight_pair.h"
+
+#ifndef CRUFT_TIGHT_PAIR_USE_BMI2
+#   if defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+#       define CRUFT_TIGHT_PAIR_USE_BMI2 1
+#   else
+#       define CRUFT_TIGHT_PAIR_USE_BMI2 0
+#   endif
+#endif
+
+#if CRUFT_TIGHT_PAIR_USE_BMI2
+#   include <immintrin.h>
+#endif
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Spread the bits of a 32-bit integer to the even bits of a
+        // 64-bit integer and back
+
+        constexpr auto morton_spread_magic(std::uint32_t value) noexcept
+            -> std::uint64_t
+        {
+            std::uint64_t res = value;
+            res = (res | (res << 16)) & 0x0000ffff0000ffffu;
+            res = (res | (res << 8))  & 0x00ff00ff00ff00ffu;
+            res = (res | (res << 4))  & 0x0f0f0f0f0f0f0f0fu;
+            res = (res | (res << 2))  & 0x3333333333333333u;
+            res = (res | (res << 1))  & 0x5555555555555555u;
+            return res;
+        }
+
+        constexpr auto morton_compact_magic(std::uint64_t value) noexcept
+            -> std::uint32_t
+        {
+            std::uint64_t res = value & 0x5555555555555555u;
+            res = (res | (res >> 1))  & 0x3333333333333333u;
+            res = (res | (res >> 2))  & 0x0f0f0f0f0f0f0f0fu;
+            res = (res | (res >> 4))  & 0x00ff00ff00ff00ffu;
+            res = (res | (res >> 8))  & 0x0000ffff0000ffffu;
+            res = (res | (res >> 16)) & 0x00000000ffffffffu;
+            return static_cast<std::uint32_t>(res);
+        }
+
+        inline auto morton_spread(std::uint32_t value) noexcept
+            -> std::uint64_t
+        {
+#if CRUFT_TIGHT_PAIR_USE_BMI2
+            return _pdep_u64(value, 0x5555555555555555u);
+#else
+            return morton_spread_magic(value);
+#endif
+        }
+
+        inline auto morton_compact(std::uint64_t value) noexcept
+            -> std::uint32_t
+        {
+#if CRUFT_TIGHT_PAIR_USE_BMI2
+            return static_cast<std::uint32_t>(_pext_u64(value, 0x5555555555555555u));
+#else
+            return morton_compact_magic(value);
+#endif
+        }
+
+        template<typename T>
+        using morton_code_t = decltype(twice_as_big<T>());
+
+        template<typename T>
+        auto morton_spread_element(T value) noexcept
+            -> morton_code_t<T>
+        {
+            using code_t = morton_code_t<T>;
+            if constexpr (sizeof(T) <= sizeof(std::uint32_t)) {
+                return static_cast<code_t>(morton_spread(value));
+            } else {
+                // 64-bit elements: spread each half separately
+                static_assert(sizeof(T) == sizeof(std::uint64_t));
+                auto low = morton_spread(static_cast<std::uint32_t>(value));
+                auto high = morton_spread(static_cast<std::uint32_t>(value >> 32));
+                return static_cast<code_t>(high) << 64 | low;
+            }
+        }
+
+        template<typename T>
+        auto morton_compact_element(morton_code_t<T> code) noexcept
+            -> T
+        {
+            if constexpr (sizeof(T) <= sizeof(std::uint32_t)) {
+                return static_cast<T>(morton_compact(static_cast<std::uint64_t>(code)));
+            } else {
+                static_assert(sizeof(T) == sizeof(std::uint64_t));
+                auto low = morton_compact(static_cast<std::uint64_t>(code));
+                auto high = morton_compact(static_cast<std::uint64_t>(code >> 64));
+                return static_cast<T>(static_cast<T>(high) << 32 | low);
+            }
+        }
+
+        template<typename T>
+        constexpr auto check_morton_eligible() noexcept
+            -> void
+        {
+            static_assert(std::is_unsigned_v<T> && not std::is_same_v<std::remove_cv_t<T>, bool>,
+                          "Morton codes are only available for pairs of unsigned integers");
+            static_assert(has_twice_as_big<T>::value && sizeof(T) <= sizeof(std::uint64_t),
+                          "no unsigned integer type is big enough to hold the Morton code");
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Conversion between a pair of unsigned integers and its
+    // Morton code (Z-order): the bits of the first element are
+    // interleaved with those of the second element, the first
+    // element occupying the most significant bit of each pair
+    // of bits, so that comparing codes orders the pairs along
+    // a Z-order curve
+    //
+    // BMI2 pdep/pext instructions are used when available, define
+    // CRUFT_TIGHT_PAIR_USE_BMI2 to 0 to avoid them (they are very
+    // slow on AMD processors older than Zen 3); these functions
+    // can't be used in constant expressions because of them
+
+    template<typename T>
+    auto morton_encode(tight_pair<T, T> const& pair) noexcept
+        -> detail::morton_code_t<T>
+    {
+        detail::check_morton_eligible<T>();
+        using cruft::get;
+        return static_cast<detail::morton_code_t<T>>(
+            detail::morton_spread_element(get<0>(pair)) << 1
+            | detail::morton_spread_element(get<1>(pair))
+        );
+    }
+
+    template<typename T>
+    auto morton_decode(detail::morton_code_t<T> code) noexcept
+        -> tight_pair<T, T>
+    {
+        detail::check_morton_eligible<T>();
+        return tight_pair<T, T>(
+            detail::morton_compact_element<T>(static_cast<detail::morton_code_t<T>>(code >> 1)),
+            detail::morton_compact_element<T>(code)
+        );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Function objects
+
+    // Projection returning the Morton code of a pair, suitable
+    // as a key for radix sorts
+    struct morton_key
+    {
+        template<typename T>
+        auto operator()(tight_pair<T, T> const& pair) const noexcept
+            -> detail::morton_code_t<T>
+        {
+            return cruft::morton_encode(pair);
+        }
+    };
+
+    // Comparison ordering pairs along a Z-order curve
+    struct morton_less
+    {
+        template<typename T>
+        auto operator()(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) const noexcept
+            -> bool
+        {
+            return cruft::morton_encode(lhs) < cruft::morton_encode(rhs);
+        }
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_MORTON_H_
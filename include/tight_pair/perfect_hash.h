@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_PERFECT_HASH_H_
+#define CRUFT_TIGHT_PAIR_PERFECT_HASH_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "../tight_pair.h"
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        constexpr auto ceil_log2(std::size_t value) noexcept
+            -> std::size_t
+        {
+            std::size_t res = 0;
+            while ((std::size_t(1) << res) < value) {
+                ++res;
+            }
+            return res;
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Hash of the packed integer representation of a pair: a
+        // multiplication whose high bits are folded into the low
+        // ones, since the low bits of a product only depend on the
+        // low bits of the key
+
+        template<typename Key>
+        constexpr auto perfect_hash_mix(Key const& key, std::uint64_t multiplier) noexcept
+            -> std::uint64_t
+        {
+            auto packed = get_twice_as_big(key);
+            std::uint64_t value = 0;
+            if constexpr (sizeof(packed) > sizeof(std::uint64_t)) {
+                value = static_cast<std::uint64_t>(packed ^ (packed >> 64));
+            } else {
+                value = static_cast<std::uint64_t>(packed);
+            }
+            std::uint64_t hash = value * multiplier;
+            return hash ^ (hash >> 32);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Immutable map whose keys are packable pairs, meant to be
+    // built at compile time
+    //
+    // The map is a perfect hash table with one slot per key,
+    // rounded up to a power of 2: a lookup hashes the packed key
+    // with a multiplication, reads the displacement of the bucket
+    // the hash falls in, and compares the key of a single slot.
+    // There are no collision chains.
+    //
+    // The multiplier and the displacements are searched when the
+    // map is built, with the hash-and-displace method: buckets are
+    // placed from the biggest to the smallest, each one XORing the
+    // hashes of its keys with the first displacement that sends
+    // them to free slots. Building the map takes O(N²) steps, so
+    // it's meant for small fixed key sets such as opcodes.
+
+    template<typename Key, typename Mapped, std::size_t N>
+    class constexpr_pair_map
+    {
+        static_assert(detail::is_packable_pair_v<Key>,
+                      "constexpr_pair_map requires pairs of unsigned integers as keys");
+        static_assert(std::is_default_constructible_v<Mapped>,
+                      "constexpr_pair_map requires a default-constructible mapped type");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using key_type = Key;
+            using mapped_type = Mapped;
+            using value_type = tight_pair<Key, Mapped>;
+            using size_type = std::size_t;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            constexpr explicit constexpr_pair_map(std::array<value_type, N> const& entries):
+                multiplier_(0x9e3779b97f4a7c15u),
+                displacements_{},
+                slots_{}
+            {
+                for (std::size_t i = 0 ; i < N ; ++i) {
+                    for (std::size_t j = i + 1 ; j < N ; ++j) {
+                        if (entries[i].template get<0>() == entries[j].template get<0>()) {
+                            throw std::invalid_argument("constexpr_pair_map: duplicate keys");
+                        }
+                    }
+                }
+
+                for (int attempt = 0 ; attempt < max_attempts ; ++attempt) {
+                    if (try_build(entries)) {
+                        return;
+                    }
+                    // Next odd multiplier in a linear congruential sequence
+                    multiplier_ = (multiplier_ * 6364136223846793005u + 1442695040888963407u) | 1u;
+                }
+                throw std::logic_error("constexpr_pair_map: no perfect hash function found");
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+
+            static constexpr auto size() noexcept
+                -> size_type
+            {
+                return N;
+            }
+
+            static constexpr auto empty() noexcept
+                -> bool
+            {
+                return N == 0;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Lookup
+
+            constexpr auto find(Key const& key) const noexcept
+                -> value_type const*
+            {
+                if constexpr (N == 0) {
+                    (void) key;
+                    return nullptr;
+                } else {
+                    auto const& slot = slots_[slot_of(detail::perfect_hash_mix(key, multiplier_))];
+                    return slot.template get<0>() == key ? &slot : nullptr;
+                }
+            }
+
+            constexpr auto contains(Key const& key) const noexcept
+                -> bool
+            {
+                return find(key) != nullptr;
+            }
+
+            constexpr auto at(Key const& key) const
+                -> Mapped const&
+            {
+                auto entry = find(key);
+                if (entry == nullptr) {
+                    throw std::out_of_range("constexpr_pair_map::at: key not found");
+                }
+                return entry->template get<1>();
+            }
+
+        private:
+
+            static constexpr int max_attempts = 64;
+            static constexpr std::size_t slot_bits = detail::ceil_log2(N);
+            static constexpr std::size_t nb_slots = std::size_t(1) << slot_bits;
+            // About 2 keys per bucket, and at least 2 buckets so that
+            // the bucket shift stays below 64
+            static constexpr std::size_t bucket_bits = slot_bits > 1 ? slot_bits - 1 : 1;
+            static constexpr std::size_t nb_buckets = std::size_t(1) << bucket_bits;
+
+            static constexpr auto bucket_of(std::uint64_t hash) noexcept
+                -> std::size_t
+            {
+                std::uint64_t bucket = hash >> (64 - bucket_bits);
+                return bucket;
+            }
+
+            constexpr auto slot_of(std::uint64_t hash) const noexcept
+                -> std::size_t
+            {
+                std::uint64_t slot = (hash ^ displacements_[bucket_of(hash)]) & (nb_slots - 1);
+                return slot;
+            }
+
+            constexpr auto try_build(std::array<value_type, N> const& entries)
+                -> bool
+            {
+                std::array<std::uint64_t, N> hashes{};
+                std::array<std::size_t, nb_buckets> bucket_sizes{};
+                std::size_t max_bucket_size = 0;
+                for (std::size_t i = 0 ; i < N ; ++i) {
+                    hashes[i] = detail::perfect_hash_mix(entries[i].template get<0>(), multiplier_);
+                    auto bucket_size = ++bucket_sizes[bucket_of(hashes[i])];
+                    max_bucket_size = bucket_size > max_bucket_size ? bucket_size : max_bucket_size;
+                }
+
+                std::array<bool, nb_slots> used{};
+                std::array<std::size_t, N> members{};
+                for (std::size_t size = max_bucket_size ; size > 0 ; --size) {
+                    for (std::size_t bucket = 0 ; bucket < nb_buckets ; ++bucket) {
+                        if (bucket_sizes[bucket] != size) {
+                            continue;
+                        }
+                        std::size_t nb_members = 0;
+                        for (std::size_t i = 0 ; i < N ; ++i) {
+                            if (bucket_of(hashes[i]) == bucket) {
+                                members[nb_members++] = i;
+                            }
+                        }
+
+                        // XORing with a displacement is a bijection, so keys
+                        // of a bucket land in different slots if and only if
+                        // their hashes differ in the low bits
+                        bool placed = false;
+                        for (std::size_t disp = 0 ; disp < nb_slots && not placed ; ++disp) {
+                            placed = true;
+                            for (std::size_t m = 0 ; m < nb_members ; ++m) {
+                                auto slot = (static_cast<std::size_t>(hashes[members[m]]) ^ disp) & (nb_slots - 1);
+                                if (used[slot]) {
+                                    placed = false;
+                                    break;
+                                }
+                                for (std::size_t other = 0 ; other < m ; ++other) {
+                                    if (((hashes[members[other]] ^ hashes[members[m]]) & (nb_slots - 1)) == 0) {
+                                        return false;
+                                    }
+                                }
+                            }
+                            if (placed) {
+                                displacements_[bucket] = static_cast<std::uint32_t>(disp);
+                                for (std::size_t m = 0 ; m < nb_members ; ++m) {
+                                    auto slot = (static_cast<std::size_t>(hashes[members[m]]) ^ disp) & (nb_slots - 1);
+                                    used[slot] = true;
+                                    slots_[slot] = entries[members[m]];
+                                }
+                            }
+                        }
+                        if (not placed) {
+                            return false;
+                        }
+                    }
+                }
+
+                // A key found in a slot it doesn't hash to can't match
+                // any lookup, so free slots hold a copy of a real entry
+                for (std::size_t slot = 0 ; slot < nb_slots ; ++slot) {
+                    if (not used[slot] && N > 0) {
+                        slots_[slot] = entries[0];
+                    }
+                }
+                return true;
+            }
+
+            std::uint64_t multiplier_;
+            std::array<std::uint32_t, nb_buckets> displacements_;
+            std::array<value_type, nb_slots> slots_;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Build a constexpr_pair_map, meant to initialize a constexpr
+    // variable:
+    //
+    //     constexpr auto map = cruft::make_constexpr_pair_map(std::array{ ... });
+    //
+    // Duplicate keys make the construction throw, which is a
+    // compile-time error in a constant expression.
+
+    template<typename Key, typename Mapped, std::size_t N>
+    constexpr auto make_constexpr_pair_map(std::array<tight_pair<Key, Mapped>, N> const& entries)
+        -> constexpr_pair_map<Key, Mapped, N>
+    {
+        return constexpr_pair_map<Key, Mapped, N>(entries);
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_PERFECT_HASH_H_
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_PREFIXED_STRING_H_
+#define CRUFT_TIGHT_PAIR_PREFIXED_STRING_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // First bytes of a string as a big-endian integer, padded
+        // with zeros: comparing the prefixes of two strings gives
+        // the same result as comparing the strings themselves,
+        // unless the prefixes are equal
+
+        constexpr auto load_string_prefix(std::string_view str) noexcept
+            -> std::uint64_t
+        {
+            constexpr std::size_t prefix_size = sizeof(std::uint64_t);
+
+            std::uint64_t res = 0;
+            if (str.size() >= prefix_size) {
+                // Fixed-size loop, compiled to a load and a byte swap
+                for (std::size_t i = 0 ; i < prefix_size ; ++i) {
+                    res = res << CHAR_BIT | static_cast<unsigned char>(str[i]);
+                }
+            } else {
+                for (std::size_t i = 0 ; i < prefix_size ; ++i) {
+                    res <<= CHAR_BIT;
+                    if (i < str.size()) {
+                        res |= static_cast<unsigned char>(str[i]);
+                    }
+                }
+            }
+            return res;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Non-owning view of a string that caches its first bytes
+    //
+    // Comparisons first compare the cached prefixes as integers,
+    // and only compare the viewed characters when the prefixes
+    // are equal, skipping the bytes already known to be equal.
+    // Strings that differ in their first 8 bytes are therefore
+    // compared without reading the characters they point to.
+    // The order is the one of std::string_view.
+
+    class prefixed_string_view
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            constexpr prefixed_string_view() noexcept:
+                prefix_(0),
+                view_()
+            {}
+
+            constexpr prefixed_string_view(std::string_view view) noexcept:
+                prefix_(detail::load_string_prefix(view)),
+                view_(view)
+            {}
+
+            constexpr prefixed_string_view(char const* str) noexcept:
+                prefixed_string_view(std::string_view(str))
+            {}
+
+            ////////////////////////////////////////////////////////////
+            // Accessors
+
+            constexpr auto view() const noexcept
+                -> std::string_view
+            {
+                return view_;
+            }
+
+            constexpr operator std::string_view() const noexcept
+            {
+                return view_;
+            }
+
+            constexpr auto prefix() const noexcept
+                -> std::uint64_t
+            {
+                return prefix_;
+            }
+
+            constexpr auto size() const noexcept
+                -> std::size_t
+            {
+                return view_.size();
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Three-way comparison: negative, zero or positive
+
+            constexpr auto compare(prefixed_string_view const& other) const noexcept
+                -> int
+            {
+                if (prefix_ != other.prefix_) {
+                    return prefix_ < other.prefix_ ? -1 : 1;
+                }
+                // Equal prefixes mean that the characters shared by
+                // both strings in the first 8 bytes are equal
+                auto skip = std::min({ sizeof(std::uint64_t), view_.size(), other.view_.size() });
+                return view_.substr(skip).compare(other.view_.substr(skip));
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Comparison operators (hidden friends)
+
+            friend constexpr auto operator==(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                return lhs.prefix_ == rhs.prefix_
+                    && lhs.view_.size() == rhs.view_.size()
+                    && lhs.compare(rhs) == 0;
+            }
+
+            friend constexpr auto operator!=(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                return not(lhs == rhs);
+            }
+
+            friend constexpr auto operator<(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                if (lhs.prefix_ != rhs.prefix_) {
+                    return lhs.prefix_ < rhs.prefix_;
+                }
+                return lhs.compare(rhs) < 0;
+            }
+
+            friend constexpr auto operator<=(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                return not(rhs < lhs);
+            }
+
+            friend constexpr auto operator>(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                return rhs < lhs;
+            }
+
+            friend constexpr auto operator>=(prefixed_string_view const& lhs, prefixed_string_view const& rhs) noexcept
+                -> bool
+            {
+                return not(lhs < rhs);
+            }
+
+        private:
+
+            std::uint64_t prefix_;
+            std::string_view view_;
+    };
+
+    namespace detail
+    {
+        template<>
+        struct has_three_way_compare<prefixed_string_view>:
+            std::true_type
+        {};
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Convert pairs whose first member is a string view to pairs
+    // whose first member caches its prefix, and back
+
+    template<typename InputIterator, typename OutputIterator>
+    auto prefix_first(InputIterator first, InputIterator last, OutputIterator out)
+        -> OutputIterator
+    {
+        return std::transform(first, last, out, [](auto const& pair) {
+            using second_type = std::tuple_element_t<1, std::decay_t<decltype(pair)>>;
+            using cruft::get;
+            return tight_pair<prefixed_string_view, second_type>(get<0>(pair), get<1>(pair));
+        });
+    }
+
+    template<typename InputIterator, typename OutputIterator>
+    auto unprefix_first(InputIterator first, InputIterator last, OutputIterator out)
+        -> OutputIterator
+    {
+        return std::transform(first, last, out, [](auto const& pair) {
+            using second_type = std::tuple_element_t<1, std::decay_t<decltype(pair)>>;
+            using cruft::get;
+            return tight_pair<std::string_view, second_type>(get<0>(pair).view(), get<1>(pair));
+        });
+    }
+}
+
+namespace cppsort
+{
+    ////////////////////////////////////////////////////////////
+    // Comparisons of prefixed strings, and of pairs starting with
+    // one, are mostly decided by an integer comparison: the
+    // fallback to the characters is only taken on equal prefixes
+
+    template<typename Compare, typename T>
+    struct is_probably_branchless_comparison;
+
+    template<>
+    struct is_probably_branchless_comparison<std::less<>, cruft::prefixed_string_view>:
+        std::true_type
+    {};
+
+    template<>
+    struct is_probably_branchless_comparison<std::less<cruft::prefixed_string_view>, cruft::prefixed_string_view>:
+        std::true_type
+    {};
+
+    template<>
+    struct is_probably_branchless_comparison<std::greater<>, cruft::prefixed_string_view>:
+        std::true_type
+    {};
+
+    template<>
+    struct is_probably_branchless_comparison<std::greater<cruft::prefixed_string_view>, cruft::prefixed_string_view>:
+        std::true_type
+    {};
+
+    template<typename T>
+    struct is_probably_branchless_comparison<std::less<>, cruft::tight_pair<cruft::prefixed_string_view, T>>:
+        std::true_type
+    {};
+
+    template<typename T>
+    struct is_probably_branchless_comparison<std::greater<>, cruft::tight_pair<cruft::prefixed_string_view, T>>:
+        std::true_type
+    {};
+}
+
+#endif // CRUFT_TIGHT_PAIR_PREFIXED_STRING_H_
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_REDUCE_H_
+#define CRUFT_TIGHT_PAIR_REDUCE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        template<typename Iterator>
+        using first_member_t = std::decay_t<decltype(get<0>(*std::declval<Iterator&>()))>;
+
+        template<typename Iterator>
+        using second_member_t = std::decay_t<decltype(get<1>(*std::declval<Iterator&>()))>;
+
+        // Number of elements checked at once for a run boundary: in
+        // a range sorted by first member, a block whose first and
+        // last elements have the same first member belongs to a
+        // single run and can be reduced without further checks
+        constexpr std::size_t reduce_block_size = 64;
+
+        // Independent accumulators used to reduce a block, which
+        // lets the compiler vectorize the reduction (GCC needs -O3
+        // or -ftree-vectorize to do so)
+        constexpr std::size_t reduce_lanes = 8;
+
+        template<typename RandomAccessIterator, typename BinaryOperation>
+        auto reduce_block(RandomAccessIterator first, BinaryOperation& op)
+            -> second_member_t<RandomAccessIterator>
+        {
+            using value_type = second_member_t<RandomAccessIterator>;
+
+            if constexpr (std::is_arithmetic_v<value_type>) {
+                value_type lanes[reduce_lanes];
+                for (std::size_t j = 0 ; j < reduce_lanes ; ++j) {
+                    lanes[j] = get<1>(first[j]);
+                }
+                for (std::size_t i = reduce_lanes ; i < reduce_block_size ; i += reduce_lanes) {
+                    for (std::size_t j = 0 ; j < reduce_lanes ; ++j) {
+                        lanes[j] = op(lanes[j], get<1>(first[i + j]));
+                    }
+                }
+                for (std::size_t width = reduce_lanes / 2 ; width > 0 ; width /= 2) {
+                    for (std::size_t j = 0 ; j < width ; ++j) {
+                        lanes[j] = op(lanes[j], lanes[j + width]);
+                    }
+                }
+                return lanes[0];
+            } else {
+                value_type res = get<1>(first[0]);
+                for (std::size_t i = 1 ; i < reduce_block_size ; ++i) {
+                    res = op(std::move(res), get<1>(first[i]));
+                }
+                return res;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Reduce the second members of consecutive pairs sharing the
+    // same first member with op, and write one pair per run made
+    // of the first member and the reduction, like thrust's
+    // reduce_by_key
+    //
+    // The range must be sorted by first member, and op must be
+    // associative and commutative like for std::reduce: inside a
+    // run, blocks of elements are reduced with several independent
+    // accumulators so that the compiler can vectorize them, which
+    // means that floating point sums are not computed in order
+
+    template<
+        typename ForwardIterator,
+        typename OutputIterator,
+        typename BinaryOperation = std::plus<>
+    >
+    auto reduce_by_first(ForwardIterator first, ForwardIterator last,
+                         OutputIterator out, BinaryOperation op={})
+        -> OutputIterator
+    {
+        using key_type = detail::first_member_t<ForwardIterator>;
+        using value_type = detail::second_member_t<ForwardIterator>;
+        using category = typename std::iterator_traits<ForwardIterator>::iterator_category;
+        constexpr auto block_size = static_cast<std::ptrdiff_t>(detail::reduce_block_size);
+
+        while (first != last) {
+            key_type key = get<0>(*first);
+            value_type acc = get<1>(*first);
+            ++first;
+
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>) {
+                // Reduce up to a block of elements one by one, and switch
+                // to whole blocks only for runs longer than that, which
+                // keeps short runs as cheap as with a naive loop
+                for (;;) {
+                    auto stop = last - first > block_size ? first + block_size : last;
+                    for (; first != stop && get<0>(*first) == key ; ++first) {
+                        acc = op(std::move(acc), get<1>(*first));
+                    }
+                    if (first != stop || first == last) {
+                        break;
+                    }
+                    while (last - first >= block_size && get<0>(first[block_size - 1]) == key) {
+                        acc = op(std::move(acc), detail::reduce_block(first, op));
+                        first += block_size;
+                    }
+                }
+            } else {
+                for (; first != last && get<0>(*first) == key ; ++first) {
+                    acc = op(std::move(acc), get<1>(*first));
+                }
+            }
+
+            *out = tight_pair<key_type, value_type>(std::move(key), std::move(acc));
+            ++out;
+        }
+        return out;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Write one pair per run of consecutive pairs sharing the same
+    // first member, made of the first member and the length of the
+    // run; the range must be sorted by first member
+
+    template<typename ForwardIterator, typename OutputIterator>
+    auto run_lengths_by_first(ForwardIterator first, ForwardIterator last, OutputIterator out)
+        -> OutputIterator
+    {
+        using key_type = detail::first_member_t<ForwardIterator>;
+        using category = typename std::iterator_traits<ForwardIterator>::iterator_category;
+        constexpr auto block_size = static_cast<std::ptrdiff_t>(detail::reduce_block_size);
+
+        while (first != last) {
+            key_type key = get<0>(*first);
+            std::size_t length = 1;
+            ++first;
+
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>) {
+                // Same strategy as reduce_by_first
+                for (;;) {
+                    auto stop = last - first > block_size ? first + block_size : last;
+                    for (; first != stop && get<0>(*first) == key ; ++first) {
+                        ++length;
+                    }
+                    if (first != stop || first == last) {
+                        break;
+                    }
+                    while (last - first >= block_size && get<0>(first[block_size - 1]) == key) {
+                        length += detail::reduce_block_size;
+                        first += block_size;
+                    }
+                }
+            } else {
+                for (; first != last && get<0>(*first) == key ; ++first) {
+                    ++length;
+                }
+            }
+
+            *out = tight_pair<key_type, std::size_t>(std::move(key), length);
+            ++out;
+        }
+        return out;
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_REDUCE_H_
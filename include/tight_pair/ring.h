@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_RING_H_
+#define CRUFT_TIGHT_PAIR_RING_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Number of threads allowed on each side of a pair_ring
+
+    enum struct ring_kind
+    {
+        spsc,   // single producer, single consumer
+        mpmc    // multiple producers, multiple consumers
+    };
+
+    namespace detail
+    {
+        // Producer and consumer indices live on different cache
+        // lines so that they don't slow each other down
+        struct alignas(64) ring_index
+        {
+            std::atomic<std::size_t> value{0};
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Bounded queue of packable pairs
+    //
+    // Every slot is a single atomic packed word, and an empty slot
+    // holds a reserved sentinel value instead of having a sequence
+    // number next to it: the pair whose members are all ones can't
+    // be pushed to the ring.
+    //
+    // In the SPSC variant the producer and the consumer only look
+    // at the slots to know whether the ring is full or empty, and
+    // never read the index of the other side.
+    //
+    // In the MPMC variant threads first claim tickets by moving the
+    // shared indices with compare-and-swap, then fill or empty the
+    // slot of their ticket. A thread that claimed a slot might wait
+    // for the thread that claimed the same slot one lap earlier, so
+    // the queue isn't lock-free when threads get descheduled in the
+    // middle of an operation.
+    //
+    // The MPMC variant isn't FIFO: the slots don't record the lap
+    // of their ticket, so when the producer of a ticket is slower
+    // than the producer of the same slot one lap later, the later
+    // value is popped first. No value is lost or popped twice.
+
+    template<typename T1, typename T2, ring_kind Kind=ring_kind::mpmc>
+    class pair_ring
+    {
+        static_assert(std::is_same_v<T1, T2> && detail::can_optimize_compare<T1>::value,
+                      "pair_ring only supports pairs that can be represented by a packed integer");
+
+        using key_word = decltype(detail::twice_as_big<T1>());
+
+        static_assert(std::atomic<key_word>::is_always_lock_free,
+                      "the packed representation of the pair must be a lock-free atomic type");
+
+        static constexpr key_word empty_slot = std::numeric_limits<key_word>::max();
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = tight_pair<T1, T2>;
+            using size_type = std::size_t;
+
+            // Value marking empty slots, which can't be pushed
+            static auto reserved_value() noexcept
+                -> value_type
+            {
+                return detail::from_twice_as_big<T1>(empty_slot);
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            // The capacity is rounded up to a power of two, throws
+            // std::length_error when there is no such size_type
+            explicit pair_ring(size_type capacity):
+                capacity_(round_capacity(capacity)),
+                slots_(new std::atomic<key_word>[capacity_])
+            {
+                for (size_type i = 0 ; i < capacity_ ; ++i) {
+                    slots_[i].store(empty_slot, std::memory_order_relaxed);
+                }
+            }
+
+            pair_ring(pair_ring const&) = delete;
+            auto operator=(pair_ring const&) -> pair_ring& = delete;
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+
+            auto capacity() const noexcept
+                -> size_type
+            {
+                return capacity_;
+            }
+
+            // Only a snapshot when other threads use the ring
+            auto size() const noexcept
+                -> size_type
+            {
+                auto head = head_.value.load(std::memory_order_acquire);
+                auto tail = tail_.value.load(std::memory_order_acquire);
+                return tail - head;
+            }
+
+            auto empty() const noexcept
+                -> bool
+            {
+                return size() == 0;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Single element operations, false when the ring is full
+            // or empty
+
+            auto try_push(value_type const& value)
+                -> bool
+            {
+                return push_n(&value, 1) == 1;
+            }
+
+            auto try_pop(value_type& value)
+                -> bool
+            {
+                return pop_n(&value, 1) == 1;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Batched operations: push or pop up to count elements and
+            // return how many were transferred. The MPMC variant claims
+            // all the slots of a batch with a single compare-and-swap
+
+            template<typename RandomAccessIterator>
+            auto push_n(RandomAccessIterator first, size_type count)
+                -> size_type
+            {
+                if constexpr (Kind == ring_kind::spsc) {
+                    auto tail = tail_.value.load(std::memory_order_relaxed);
+                    count = count < capacity_ ? count : capacity_;
+                    size_type pushed = 0;
+                    // The consumer empties slots in order, so all the slots
+                    // of the batch are empty if the last one is
+                    if (count > 0 && load(tail + count - 1) == empty_slot) {
+                        pushed = count;
+                    } else {
+                        while (pushed < count && load(tail + pushed) == empty_slot) {
+                            ++pushed;
+                        }
+                    }
+                    for (size_type i = 0 ; i < pushed ; ++i) {
+                        slot(tail + i).store(to_word(first[i]), std::memory_order_release);
+                    }
+                    tail_.value.store(tail + pushed, std::memory_order_release);
+                    return pushed;
+                } else {
+                    size_type tail;
+                    size_type pushed;
+                    for (;;) {
+                        // Read head first so that tail can't lag behind it
+                        auto head = head_.value.load(std::memory_order_acquire);
+                        tail = tail_.value.load(std::memory_order_relaxed);
+                        auto used = tail - head;
+                        if (used > capacity_) {
+                            // Inconsistent snapshot, try again
+                            continue;
+                        }
+                        if (used == capacity_) {
+                            return 0;
+                        }
+                        pushed = count < capacity_ - used ? count : capacity_ - used;
+                        if (pushed == 0) {
+                            return 0;
+                        }
+                        if (tail_.value.compare_exchange_weak(tail, tail + pushed,
+                                                              std::memory_order_acq_rel,
+                                                              std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    for (size_type i = 0 ; i < pushed ; ++i) {
+                        // Wait for the consumer of the previous lap
+                        auto word = to_word(first[i]);
+                        auto& target = slot(tail + i);
+                        auto expected = empty_slot;
+                        while (not target.compare_exchange_weak(expected, word,
+                                                                std::memory_order_release,
+                                                                std::memory_order_relaxed)) {
+                            expected = empty_slot;
+                            std::this_thread::yield();
+                        }
+                    }
+                    return pushed;
+                }
+            }
+
+            template<typename OutputIterator>
+            auto pop_n(OutputIterator out, size_type count)
+                -> size_type
+            {
+                if constexpr (Kind == ring_kind::spsc) {
+                    auto head = head_.value.load(std::memory_order_relaxed);
+                    size_type popped = 0;
+                    for (; popped < count ; ++popped) {
+                        auto& source = slot(head + popped);
+                        auto word = source.load(std::memory_order_acquire);
+                        if (word == empty_slot) {
+                            break;
+                        }
+                        *out = detail::from_twice_as_big<T1>(word);
+                        ++out;
+                        source.store(empty_slot, std::memory_order_release);
+                    }
+                    head_.value.store(head + popped, std::memory_order_release);
+                    return popped;
+                } else {
+                    size_type head;
+                    size_type popped;
+                    for (;;) {
+                        head = head_.value.load(std::memory_order_relaxed);
+                        auto tail = tail_.value.load(std::memory_order_acquire);
+                        if (tail == head) {
+                            return 0;
+                        }
+                        auto available = tail - head;
+                        if (available > capacity_) {
+                            continue;
+                        }
+                        popped = count < available ? count : available;
+                        if (popped == 0) {
+                            return 0;
+                        }
+                        if (head_.value.compare_exchange_weak(head, head + popped,
+                                                              std::memory_order_acq_rel,
+                                                              std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    for (size_type i = 0 ; i < popped ; ++i) {
+                        // Wait for the producer of the ticket
+                        auto& source = slot(head + i);
+                        auto word = source.load(std::memory_order_acquire);
+                        while (word == empty_slot
+                               || not source.compare_exchange_weak(word, empty_slot,
+                                                                   std::memory_order_acq_rel,
+                                                                   std::memory_order_acquire)) {
+                            if (word == empty_slot) {
+                                std::this_thread::yield();
+                                word = source.load(std::memory_order_acquire);
+                            }
+                        }
+                        *out = detail::from_twice_as_big<T1>(word);
+                        ++out;
+                    }
+                    return popped;
+                }
+            }
+
+        private:
+
+            static auto round_capacity(size_type capacity)
+                -> size_type
+            {
+                if (capacity > std::numeric_limits<size_type>::max() / 2 + 1) {
+                    throw std::length_error("pair_ring capacity is too big");
+                }
+                size_type res = 2;
+                while (res < capacity) {
+                    res *= 2;
+                }
+                return res;
+            }
+
+            static auto to_word(value_type const& value) noexcept
+                -> key_word
+            {
+                key_word word = detail::get_twice_as_big(value);
+                assert(word != empty_slot);
+                return word;
+            }
+
+            auto slot(size_type index) noexcept
+                -> std::atomic<key_word>&
+            {
+                return slots_[index & (capacity_ - 1)];
+            }
+
+            auto load(size_type index) noexcept
+                -> key_word
+            {
+                return slot(index).load(std::memory_order_acquire);
+            }
+
+            size_type capacity_;
+            std::unique_ptr<std::atomic<key_word>[]> slots_;
+            detail::ring_index head_;
+            detail::ring_index tail_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_RING_H_
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_SELECTION_H_
+#define CRUFT_TIGHT_PAIR_SELECTION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../tight_pair.h"
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        // Elements are scanned by blocks: the best key of a block is
+        // computed with independent accumulators that the compiler
+        // can vectorize, and only the block that contains the best
+        // element overall is scanned again to find its position
+        constexpr std::size_t selection_block_size = 64;
+        constexpr std::size_t selection_lanes = 8;
+
+        template<typename Iterator>
+        constexpr bool can_select_packed_v =
+            std::is_base_of_v<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category
+            > &&
+            packed_key_adapter<typename std::iterator_traits<Iterator>::value_type, std::less<>>::is_packed;
+
+        template<typename Adapter, typename RandomAccessIterator, typename KeyCompare>
+        auto block_best_key(RandomAccessIterator first, KeyCompare compare)
+            -> typename Adapter::key_type
+        {
+            typename Adapter::key_type lanes[selection_lanes];
+            for (std::size_t j = 0 ; j < selection_lanes ; ++j) {
+                lanes[j] = Adapter::to_key(first[j]);
+            }
+            for (std::size_t i = selection_lanes ; i < selection_block_size ; i += selection_lanes) {
+                for (std::size_t j = 0 ; j < selection_lanes ; ++j) {
+                    auto key = Adapter::to_key(first[i + j]);
+                    lanes[j] = compare(key, lanes[j]) ? key : lanes[j];
+                }
+            }
+            for (std::size_t width = selection_lanes / 2 ; width > 0 ; width /= 2) {
+                for (std::size_t j = 0 ; j < width ; ++j) {
+                    lanes[j] = compare(lanes[j + width], lanes[j]) ? lanes[j + width] : lanes[j];
+                }
+            }
+            return lanes[0];
+        }
+
+        // First element for which no other element compares before
+        template<typename RandomAccessIterator, typename KeyCompare>
+        auto best_element_packed(RandomAccessIterator first, RandomAccessIterator last, KeyCompare compare)
+            -> RandomAccessIterator
+        {
+            using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+            using adapter = packed_key_adapter<value_type, std::less<>>;
+            using difference_type = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+            constexpr auto block_size = static_cast<difference_type>(selection_block_size);
+
+            difference_type size = last - first;
+            if (size == 0) {
+                return last;
+            }
+
+            // The best key is searched in [best_block, best_block + block_size)
+            auto best = adapter::to_key(first[0]);
+            difference_type best_block = 0;
+            difference_type i = 0;
+            for (; size - i >= block_size ; i += block_size) {
+                auto key = block_best_key<adapter>(first + i, compare);
+                if (compare(key, best)) {
+                    best = key;
+                    best_block = i;
+                }
+            }
+            for (; i < size ; ++i) {
+                auto key = adapter::to_key(first[i]);
+                if (compare(key, best)) {
+                    best = key;
+                    best_block = i;
+                }
+            }
+
+            auto it = first + best_block;
+            while (adapter::to_key(*it) != best) {
+                ++it;
+            }
+            return it;
+        }
+
+        // Replace the top of a heap with a key that compares before
+        // it: the child to follow is selected without branches
+        template<typename Key, typename KeyCompare>
+        auto heap_replace_top(std::vector<Key>& heap, Key key, KeyCompare compare)
+            -> void
+        {
+            std::size_t size = heap.size();
+            std::size_t pos = 0;
+            for (;;) {
+                std::size_t child = 2 * pos + 1;
+                if (child >= size) {
+                    break;
+                }
+                std::size_t right = child + 1;
+                child += (right < size && compare(heap[child], heap[right]));
+                if (not compare(key, heap[child])) {
+                    break;
+                }
+                heap[pos] = std::move(heap[child]);
+                pos = child;
+            }
+            heap[pos] = std::move(key);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Equivalents of std::min_element, std::max_element and
+    // std::minmax_element that compare packable pairs as packed
+    // integers when given random-access iterators
+
+    template<typename ForwardIterator>
+    auto min_element_packed(ForwardIterator first, ForwardIterator last)
+        -> ForwardIterator
+    {
+        if constexpr (detail::can_select_packed_v<ForwardIterator>) {
+            return detail::best_element_packed(first, last, std::less<>{});
+        } else {
+            return std::min_element(first, last);
+        }
+    }
+
+    template<typename ForwardIterator>
+    auto max_element_packed(ForwardIterator first, ForwardIterator last)
+        -> ForwardIterator
+    {
+        if constexpr (detail::can_select_packed_v<ForwardIterator>) {
+            return detail::best_element_packed(first, last, std::greater<>{});
+        } else {
+            return std::max_element(first, last);
+        }
+    }
+
+    // Like std::minmax_element, returns the first smallest element
+    // and the last greatest element
+    template<typename ForwardIterator>
+    auto minmax_element_packed(ForwardIterator first, ForwardIterator last)
+        -> std::pair<ForwardIterator, ForwardIterator>
+    {
+        if constexpr (detail::can_select_packed_v<ForwardIterator>) {
+            using value_type = typename std::iterator_traits<ForwardIterator>::value_type;
+            using adapter = detail::packed_key_adapter<value_type, std::less<>>;
+            using difference_type = typename std::iterator_traits<ForwardIterator>::difference_type;
+            constexpr auto block_size = static_cast<difference_type>(detail::selection_block_size);
+
+            difference_type size = last - first;
+            if (size == 0) {
+                return { last, last };
+            }
+
+            auto min = adapter::to_key(first[0]);
+            auto max = min;
+            difference_type min_block = 0;
+            difference_type max_block = 0;
+            difference_type max_block_size = 1;
+            difference_type i = 0;
+            for (; size - i >= block_size ; i += block_size) {
+                auto block_min = detail::block_best_key<adapter>(first + i, std::less<>{});
+                auto block_max = detail::block_best_key<adapter>(first + i, std::greater<>{});
+                if (block_min < min) {
+                    min = block_min;
+                    min_block = i;
+                }
+                if (not (block_max < max)) {
+                    max = block_max;
+                    max_block = i;
+                    max_block_size = block_size;
+                }
+            }
+            for (; i < size ; ++i) {
+                auto key = adapter::to_key(first[i]);
+                if (key < min) {
+                    min = key;
+                    min_block = i;
+                }
+                if (not (key < max)) {
+                    max = key;
+                    max_block = i;
+                    max_block_size = 1;
+                }
+            }
+
+            auto min_it = first + min_block;
+            while (adapter::to_key(*min_it) != min) {
+                ++min_it;
+            }
+            auto max_it = first + (max_block + max_block_size - 1);
+            while (adapter::to_key(*max_it) != max) {
+                --max_it;
+            }
+            return { min_it, max_it };
+        } else {
+            return std::minmax_element(first, last);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Write the k smallest elements according to compare to out
+    // in sorted order, like std::partial_sort_copy would
+    //
+    // The selected elements are kept in a heap of packed keys when
+    // possible, and with random-access iterators whole blocks of
+    // elements that can't enter the heap are skipped after a
+    // vectorizable comparison against its top
+
+    template<
+        typename InputIterator,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    auto top_k(InputIterator first, InputIterator last, std::size_t k,
+               OutputIterator out, Compare compare={})
+        -> OutputIterator
+    {
+        using value_type = typename std::iterator_traits<InputIterator>::value_type;
+        using category = typename std::iterator_traits<InputIterator>::iterator_category;
+        using adapter = detail::packed_key_adapter<value_type, Compare>;
+        using key_type = typename adapter::key_type;
+
+        if (k == 0) {
+            return out;
+        }
+
+        auto key_compare = adapter::compare(compare);
+        std::vector<key_type> heap;
+        heap.reserve(k);
+        for (; first != last && heap.size() < k ; ++first) {
+            heap.push_back(adapter::to_key(*first));
+        }
+        std::make_heap(heap.begin(), heap.end(), key_compare);
+
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category> && adapter::is_packed) {
+            using difference_type = typename std::iterator_traits<InputIterator>::difference_type;
+            constexpr auto block_size = static_cast<difference_type>(detail::selection_block_size);
+
+            while (last - first >= block_size) {
+                auto threshold = heap.front();
+                std::size_t candidates = 0;
+                for (difference_type i = 0 ; i < block_size ; ++i) {
+                    candidates += key_compare(adapter::to_key(first[i]), threshold);
+                }
+                if (candidates != 0) {
+                    for (difference_type i = 0 ; i < block_size ; ++i) {
+                        auto key = adapter::to_key(first[i]);
+                        if (key_compare(key, heap.front())) {
+                            detail::heap_replace_top(heap, key, key_compare);
+                        }
+                    }
+                }
+                first += block_size;
+            }
+        }
+        for (; first != last ; ++first) {
+            // Keeps the element alive when the iterator returns
+            // prvalues, the unpacked key refers to it
+            auto&& value = *first;
+            auto const& key = adapter::to_key(value);
+            if (key_compare(key, heap.front())) {
+                detail::heap_replace_top(heap, key_type(key), key_compare);
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), key_compare);
+        for (auto& key: heap) {
+            *out = adapter::from_key(std::move(key));
+            ++out;
+        }
+        return out;
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_SELECTION_H_
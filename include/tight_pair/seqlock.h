@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_SEQLOCK_H_
+#define CRUFT_TIGHT_PAIR_SEQLOCK_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Storage of a member of a seqlock_tight_pair: the bytes of
+        // the member are spread over atomic words so that readers
+        // racing with a writer only perform atomic loads, and are
+        // copied back into a member once the read is validated.
+        // Empty members don't need any storage, and the storages are
+        // themselves stored in a tight_pair to benefit from EBCO
+
+        using seqlock_word = std::uintptr_t;
+
+        template<typename T, bool = std::is_empty_v<T>>
+        struct seqlock_member
+        {
+            static constexpr std::size_t nb_words =
+                (sizeof(T) + sizeof(seqlock_word) - 1) / sizeof(seqlock_word);
+
+            struct buffer
+            {
+                seqlock_word words[nb_words];
+            };
+
+            auto store(T const& value) noexcept
+                -> void
+            {
+                seqlock_word words[nb_words] = {};
+                std::memcpy(words, &value, sizeof(T));
+                for (std::size_t i = 0 ; i < nb_words ; ++i) {
+                    words_[i].store(words[i], std::memory_order_relaxed);
+                }
+            }
+
+            auto load(buffer& buf) const noexcept
+                -> void
+            {
+                for (std::size_t i = 0 ; i < nb_words ; ++i) {
+                    buf.words[i] = words_[i].load(std::memory_order_relaxed);
+                }
+            }
+
+            static auto get(buffer const& buf) noexcept
+                -> T
+            {
+                T res;
+                std::memcpy(&res, buf.words, sizeof(T));
+                return res;
+            }
+
+            std::atomic<seqlock_word> words_[nb_words];
+        };
+
+        template<typename T>
+        struct seqlock_member<T, true>
+        {
+            struct buffer {};
+
+            auto store(T const&) noexcept
+                -> void
+            {}
+
+            auto load(buffer&) const noexcept
+                -> void
+            {}
+
+            static auto get(buffer const&) noexcept
+                -> T
+            {
+                return T();
+            }
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Pair of trivially copyable members shared between threads
+    //
+    // Writers serialize on a sequence counter that is odd while a
+    // write is in progress. Readers copy the members optimistically
+    // and retry when the counter changed in the meantime, so they
+    // never write to memory shared with other threads and don't
+    // slow each other down. Writers never wait for readers, but
+    // readers can be starved by a continuous stream of writes.
+
+    template<typename T1, typename T2>
+    class seqlock_tight_pair
+    {
+        static_assert(std::is_trivially_copyable_v<T1> && std::is_trivially_copyable_v<T2>,
+                      "seqlock_tight_pair requires trivially copyable members");
+        static_assert(std::is_default_constructible_v<T1> && std::is_default_constructible_v<T2>,
+                      "seqlock_tight_pair requires default-constructible members");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = tight_pair<T1, T2>;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            seqlock_tight_pair():
+                seqlock_tight_pair(value_type())
+            {}
+
+            explicit seqlock_tight_pair(value_type const& value)
+            {
+                store_members(value);
+            }
+
+            seqlock_tight_pair(T1 const& first, T2 const& second):
+                seqlock_tight_pair(value_type(first, second))
+            {}
+
+            seqlock_tight_pair(seqlock_tight_pair const&) = delete;
+            auto operator=(seqlock_tight_pair const&) -> seqlock_tight_pair& = delete;
+
+            ////////////////////////////////////////////////////////////
+            // Operations
+
+            // Consistent copy of the pair as written by a single store
+            auto load() const noexcept
+                -> value_type
+            {
+                typename detail::seqlock_member<T1>::buffer first;
+                typename detail::seqlock_member<T2>::buffer second;
+                for (;;) {
+                    auto seq = sequence_.load(std::memory_order_acquire);
+                    if (seq & 1) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    get<0>(storage_).load(first);
+                    get<1>(storage_).load(second);
+                    // Keep the loads of the members before the second
+                    // load of the counter
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (sequence_.load(std::memory_order_relaxed) == seq) {
+                        break;
+                    }
+                }
+                return value_type(detail::seqlock_member<T1>::get(first),
+                                  detail::seqlock_member<T2>::get(second));
+            }
+
+            auto store(value_type const& value) noexcept
+                -> void
+            {
+                // Make the counter odd, waiting for concurrent writers
+                auto seq = sequence_.load(std::memory_order_relaxed);
+                for (;;) {
+                    if ((seq & 1) == 0 && sequence_.compare_exchange_weak(seq, seq + 1,
+                                                                          std::memory_order_acquire,
+                                                                          std::memory_order_relaxed)) {
+                        break;
+                    }
+                    if (seq & 1) {
+                        std::this_thread::yield();
+                        seq = sequence_.load(std::memory_order_relaxed);
+                    }
+                }
+                // Keep the stores of the members after the counter
+                // was made odd
+                std::atomic_thread_fence(std::memory_order_release);
+                store_members(value);
+                sequence_.store(seq + 2, std::memory_order_release);
+            }
+
+            auto store(T1 const& first, T2 const& second) noexcept
+                -> void
+            {
+                store(value_type(first, second));
+            }
+
+        private:
+
+            auto store_members(value_type const& value) noexcept
+                -> void
+            {
+                get<0>(storage_).store(get<0>(value));
+                get<1>(storage_).store(get<1>(value));
+            }
+
+            std::atomic<std::uint64_t> sequence_{0};
+            tight_pair<detail::seqlock_member<T1>, detail::seqlock_member<T2>> storage_;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_SEQLOCK_H_
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_SERIALIZATION_H_
+#define CRUFT_TIGHT_PAIR_SERIALIZATION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Canonical binary format
+    //
+    // A tight_pair<T1, T2> of unsigned integers is encoded as
+    // sizeof(T1) + sizeof(T2) bytes: the first element followed
+    // by the second element, both in big-endian order, without
+    // any padding. A table of pairs is a plain sequence of such
+    // records without header.
+    //
+    // The format doesn't depend on the byte order of the machine
+    // nor on the in-memory layout of tight_pair, and comparing
+    // two encoded pairs with memcmp gives the same result as
+    // comparing the pairs themselves.
+
+    namespace detail
+    {
+        template<typename UInt>
+        constexpr auto store_big_endian(UInt value, unsigned char* out) noexcept
+            -> unsigned char*
+        {
+            for (std::size_t i = sizeof(UInt) ; i > 0 ; --i) {
+                out[i - 1] = static_cast<unsigned char>(value);
+                value = static_cast<UInt>(value >> CHAR_BIT);
+            }
+            return out + sizeof(UInt);
+        }
+
+        template<typename UInt>
+        constexpr auto load_big_endian(unsigned char const* in) noexcept
+            -> UInt
+        {
+            UInt res = 0;
+            for (std::size_t i = 0 ; i < sizeof(UInt) ; ++i) {
+                res = static_cast<UInt>(res << CHAR_BIT | in[i]);
+            }
+            return res;
+        }
+
+        template<typename T1, typename T2>
+        constexpr auto check_serializable() noexcept
+            -> void
+        {
+            static_assert(std::is_unsigned_v<T1> && std::is_unsigned_v<T2> &&
+                          not std::is_same_v<std::remove_cv_t<T1>, bool> &&
+                          not std::is_same_v<std::remove_cv_t<T2>, bool>,
+                          "only pairs of unsigned integers can be serialized");
+        }
+    }
+
+    template<typename T1, typename T2>
+    constexpr auto encode_pair(tight_pair<T1, T2> const& pair, unsigned char* out) noexcept
+        -> unsigned char*
+    {
+        detail::check_serializable<T1, T2>();
+        using cruft::get;
+        out = detail::store_big_endian(get<0>(pair), out);
+        return detail::store_big_endian(get<1>(pair), out);
+    }
+
+    template<typename T1, typename T2>
+    constexpr auto decode_pair(unsigned char const* in) noexcept
+        -> tight_pair<T1, T2>
+    {
+        detail::check_serializable<T1, T2>();
+        return tight_pair<T1, T2>(
+            detail::load_big_endian<T1>(in),
+            detail::load_big_endian<T2>(in + sizeof(T1))
+        );
+    }
+
+    template<typename ForwardIterator>
+    auto write_pair_table(std::ostream& stream, ForwardIterator first, ForwardIterator last)
+        -> std::ostream&
+    {
+        using pair_t = typename std::iterator_traits<ForwardIterator>::value_type;
+        constexpr std::size_t record_size = sizeof(std::tuple_element_t<0, pair_t>)
+                                          + sizeof(std::tuple_element_t<1, pair_t>);
+
+        // Encode the pairs by chunks to avoid one call per pair
+        unsigned char buffer[record_size * 512];
+        while (first != last) {
+            auto out = buffer;
+            for (; first != last && out != buffer + sizeof(buffer) ; ++first) {
+                out = encode_pair(*first, out);
+            }
+            if (not stream.write(reinterpret_cast<char const*>(buffer), out - buffer)) {
+                break;
+            }
+        }
+        return stream;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Read-only view over an encoded table of pairs: the pairs
+    // are decoded on access, which is a simple byte swap at most
+
+    template<typename T1, typename T2>
+    class pair_table_view
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = tight_pair<T1, T2>;
+            using size_type = std::size_t;
+
+            static constexpr size_type record_size = sizeof(T1) + sizeof(T2);
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            constexpr pair_table_view() noexcept = default;
+
+            // bytes must be a multiple of record_size
+            constexpr pair_table_view(unsigned char const* data, size_type bytes) noexcept:
+                data_(data),
+                size_(bytes / record_size)
+            {
+                detail::check_serializable<T1, T2>();
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+
+            constexpr auto operator[](size_type pos) const noexcept
+                -> value_type
+            {
+                return cruft::decode_pair<T1, T2>(data_ + pos * record_size);
+            }
+
+            constexpr auto data() const noexcept
+                -> unsigned char const*
+            {
+                return data_;
+            }
+
+            constexpr auto size() const noexcept
+                -> size_type
+            {
+                return size_;
+            }
+
+            constexpr auto empty() const noexcept
+                -> bool
+            {
+                return size_ == 0;
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Search in a sorted table, the functions return indices
+            // and size() when nothing is found
+
+            constexpr auto lower_bound(value_type const& value) const noexcept
+                -> size_type
+            {
+                return bound(value, [](auto const& lhs, auto const& rhs) { return lhs < rhs; });
+            }
+
+            constexpr auto upper_bound(value_type const& value) const noexcept
+                -> size_type
+            {
+                return bound(value, [](auto const& lhs, auto const& rhs) { return not(rhs < lhs); });
+            }
+
+            constexpr auto find(value_type const& value) const noexcept
+                -> size_type
+            {
+                auto pos = lower_bound(value);
+                if (pos != size_ && key(pos) == key(value)) {
+                    return pos;
+                }
+                return size_;
+            }
+
+            constexpr auto contains(value_type const& value) const noexcept
+                -> bool
+            {
+                return find(value) != size_;
+            }
+
+        private:
+
+            // When both elements have the same type, an encoded record
+            // can be read as a single big-endian integer
+            static constexpr bool packed_key =
+                std::is_same_v<T1, T2> && detail::can_optimize_compare<T1>::value;
+
+            constexpr auto key(size_type pos) const noexcept
+            {
+                if constexpr (packed_key) {
+                    using key_t = decltype(detail::twice_as_big<T1>());
+                    return detail::load_big_endian<key_t>(data_ + pos * record_size);
+                } else {
+                    return (*this)[pos];
+                }
+            }
+
+            static constexpr auto key(value_type const& value) noexcept
+            {
+                if constexpr (packed_key) {
+                    return detail::get_twice_as_big(value);
+                } else {
+                    return value;
+                }
+            }
+
+            template<typename Compare>
+            constexpr auto bound(value_type const& value, Compare compare) const noexcept
+                -> size_type
+            {
+                // Branchless binary search
+                auto value_key = key(value);
+                size_type first = 0;
+                size_type len = size_;
+                while (len > 0) {
+                    size_type half = len / 2;
+                    bool go_right = compare(key(first + half), value_key);
+                    first = go_right ? first + half + 1 : first;
+                    len = go_right ? len - half - 1 : half;
+                }
+                return first;
+            }
+
+            unsigned char const* data_ = nullptr;
+            size_type size_ = 0;
+    };
+}
+
+#endif // CRUFT_TIGHT_PAIR_SERIALIZATION_H_
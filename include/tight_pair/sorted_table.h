@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_SORTED_TABLE_H_
+#define CRUFT_TIGHT_PAIR_SORTED_TABLE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Stable bottom-up merge sort usable in constant expressions:
+        // it doesn't recurse, doesn't rely on std::swap, which isn't
+        // constexpr in C++17, and merges runs back and forth between
+        // the array and a buffer of the same size
+
+        template<typename T, std::size_t N, typename Compare>
+        constexpr auto constexpr_merge_sort(std::array<T, N>& values, Compare compare)
+            -> void
+        {
+            // Indexing through pointers rather than std::array takes
+            // fewer evaluation steps
+            std::array<T, N> buffer{};
+            T* from = values.data();
+            T* to = buffer.data();
+            for (std::size_t width = 1 ; width < N ; width *= 2) {
+                for (std::size_t first = 0 ; first < N ; first += 2 * width) {
+                    std::size_t middle = first + width < N ? first + width : N;
+                    std::size_t last = first + 2 * width < N ? first + 2 * width : N;
+                    std::size_t left = first;
+                    std::size_t right = middle;
+                    for (std::size_t out = first ; out < last ; ++out) {
+                        bool take_right = left == middle || (
+                            right < last && compare(from[right], from[left])
+                        );
+                        to[out] = take_right ? from[right++] : from[left++];
+                    }
+                }
+                T* tmp = from;
+                from = to;
+                to = tmp;
+            }
+            if (from != values.data()) {
+                for (std::size_t i = 0 ; i < N ; ++i) {
+                    values[i] = buffer[i];
+                }
+            }
+        }
+
+        template<typename T, std::size_t N, typename Compare>
+        constexpr auto constexpr_sort(std::array<T, N>& values, Compare const& compare)
+            -> void
+        {
+            using adapter = packed_key_adapter<T, Compare>;
+            if constexpr (adapter::is_packed) {
+                // Sorting integers takes far fewer evaluation steps than
+                // going through the member functions of tight_pair, which
+                // matters for the compiler limits on constant evaluation
+                std::array<typename adapter::key_type, N> keys{};
+                for (std::size_t i = 0 ; i < N ; ++i) {
+                    keys[i] = adapter::to_key(values[i]);
+                }
+                constexpr_merge_sort(keys, adapter::compare(compare));
+                for (std::size_t i = 0 ; i < N ; ++i) {
+                    values[i] = adapter::from_key(keys[i]);
+                }
+            } else {
+                constexpr_merge_sort(values, compare);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Immutable sorted array meant to be built at compile time
+    //
+    // A constexpr sorted_table is sorted by the compiler and ends
+    // up in read-only memory, so the program doesn't need to sort
+    // it at startup. Lookups are branchless binary searches which
+    // compare packable pairs as packed integers, and can also be
+    // evaluated at compile time.
+
+    template<typename T, std::size_t N, typename Compare = std::less<>>
+    class sorted_table
+    {
+        static_assert(std::is_default_constructible_v<T>,
+                      "sorted_table requires default-constructible elements");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Member types
+
+            using value_type = T;
+            using size_type = std::size_t;
+            using value_compare = Compare;
+            using const_reference = T const&;
+            using const_iterator = T const*;
+            using iterator = const_iterator;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            constexpr explicit sorted_table(std::array<T, N> const& values, Compare compare = Compare()):
+                storage_(values, std::move(compare))
+            {
+                detail::constexpr_sort(storage_.template get<0>(), storage_.template get<1>());
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+
+            constexpr auto operator[](size_type pos) const noexcept
+                -> const_reference
+            {
+                return storage_.template get<0>()[pos];
+            }
+
+            constexpr auto data() const noexcept
+                -> T const*
+            {
+                return storage_.template get<0>().data();
+            }
+
+            constexpr auto begin() const noexcept
+                -> const_iterator
+            {
+                return data();
+            }
+
+            constexpr auto end() const noexcept
+                -> const_iterator
+            {
+                return data() + N;
+            }
+
+            static constexpr auto size() noexcept
+                -> size_type
+            {
+                return N;
+            }
+
+            static constexpr auto empty() noexcept
+                -> bool
+            {
+                return N == 0;
+            }
+
+            constexpr auto value_comp() const
+                -> value_compare
+            {
+                return storage_.template get<1>();
+            }
+
+            ////////////////////////////////////////////////////////////
+            // Lookup
+
+            constexpr auto lower_bound(T const& value) const
+                -> const_iterator
+            {
+                auto key_compare = adapter::compare(storage_.template get<1>());
+                return begin() + bound(value, [&](auto const& lhs, auto const& rhs) {
+                    return key_compare(lhs, rhs);
+                });
+            }
+
+            constexpr auto upper_bound(T const& value) const
+                -> const_iterator
+            {
+                auto key_compare = adapter::compare(storage_.template get<1>());
+                return begin() + bound(value, [&](auto const& lhs, auto const& rhs) {
+                    return not key_compare(rhs, lhs);
+                });
+            }
+
+            constexpr auto find(T const& value) const
+                -> const_iterator
+            {
+                auto it = lower_bound(value);
+                auto key_compare = adapter::compare(storage_.template get<1>());
+                if (it != end() && not key_compare(adapter::to_key(value), adapter::to_key(*it))) {
+                    return it;
+                }
+                return end();
+            }
+
+            constexpr auto contains(T const& value) const
+                -> bool
+            {
+                return find(value) != end();
+            }
+
+        private:
+
+            using adapter = detail::packed_key_adapter<T, Compare>;
+
+            template<typename KeyCompare>
+            constexpr auto bound(T const& value, KeyCompare compare) const
+                -> size_type
+            {
+                // Branchless binary search
+                auto value_key = adapter::to_key(value);
+                size_type first = 0;
+                size_type len = N;
+                while (len > 0) {
+                    size_type half = len / 2;
+                    bool go_right = compare(adapter::to_key((*this)[first + half]), value_key);
+                    first = go_right ? first + half + 1 : first;
+                    len = go_right ? len - half - 1 : half;
+                }
+                return first;
+            }
+
+            // Empty comparators take no space
+            tight_pair<std::array<T, N>, Compare> storage_;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Sort an array into a sorted_table, meant to initialize a
+    // constexpr variable:
+    //
+    //     constexpr auto table = cruft::make_sorted_table(std::array{ ... });
+
+    template<typename T, std::size_t N, typename Compare = std::less<>>
+    constexpr auto make_sorted_table(std::array<T, N> const& values, Compare compare = Compare())
+        -> sorted_table<T, N, Compare>
+    {
+        return sorted_table<T, N, Compare>(values, std::move(compare));
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_SORTED_TABLE_H_
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_SWAR_H_
+#define CRUFT_TIGHT_PAIR_SWAR_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <climits>
+#include <type_traits>
+#include "../tight_pair.h"
+
+namespace cruft
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////
+        // Whether element-wise operations on a tight_pair<T, T> can
+        // be performed on its packed integer representation
+
+        template<typename T>
+        struct can_use_swar:
+            std::bool_constant<
+                can_optimize_compare<T>::value &&
+                not std::is_same_v<std::remove_cv_t<T>, bool>
+            >
+        {};
+
+        template<typename T>
+        using swar_word_t = decltype(twice_as_big<T>());
+
+        ////////////////////////////////////////////////////////////
+        // Masks of the packed representation
+
+        template<typename T>
+        constexpr auto swar_high_bits() noexcept
+            -> swar_word_t<T>
+        {
+            // Most significant bit of each half
+            using word_t = swar_word_t<T>;
+            constexpr auto half_bits = sizeof(T) * CHAR_BIT;
+            return static_cast<word_t>(
+                word_t(1) << (half_bits - 1) | word_t(1) << (2 * half_bits - 1)
+            );
+        }
+
+        template<typename T>
+        constexpr auto swar_expand(swar_word_t<T> high) noexcept
+            -> swar_word_t<T>
+        {
+            // Turns a word where only the most significant bit of each
+            // half can be set into a word where every half is either
+            // all zeros or all ones; the subtraction can't borrow from
+            // the neighbouring half since only halves with their most
+            // significant bit set have their low bit set
+            constexpr auto half_bits = sizeof(T) * CHAR_BIT;
+            return static_cast<swar_word_t<T>>(high | (high - (high >> (half_bits - 1))));
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Element-wise operations on packed words, the carries and
+        // borrows never cross the boundary between halves
+
+        template<typename T>
+        constexpr auto swar_add(swar_word_t<T> lhs, swar_word_t<T> rhs) noexcept
+            -> swar_word_t<T>
+        {
+            constexpr auto high = swar_high_bits<T>();
+            constexpr auto low = static_cast<swar_word_t<T>>(~high);
+            return static_cast<swar_word_t<T>>(
+                ((lhs & low) + (rhs & low)) ^ ((lhs ^ rhs) & high)
+            );
+        }
+
+        template<typename T>
+        constexpr auto swar_sub(swar_word_t<T> lhs, swar_word_t<T> rhs) noexcept
+            -> swar_word_t<T>
+        {
+            constexpr auto high = swar_high_bits<T>();
+            constexpr auto low = static_cast<swar_word_t<T>>(~high);
+            return static_cast<swar_word_t<T>>(
+                ((lhs | high) - (rhs & low)) ^ ((lhs ^ ~rhs) & high)
+            );
+        }
+
+        template<typename T>
+        constexpr auto swar_less_mask(swar_word_t<T> lhs, swar_word_t<T> rhs) noexcept
+            -> swar_word_t<T>
+        {
+            // The most significant bit of each half of the expression
+            // below is the borrow out of the element-wise subtraction
+            // (Hacker's Delight, 2-13)
+            auto diff = swar_sub<T>(lhs, rhs);
+            auto borrows = (~lhs & rhs) | (~(lhs ^ rhs) & diff);
+            return swar_expand<T>(static_cast<swar_word_t<T>>(borrows & swar_high_bits<T>()));
+        }
+
+        template<typename T>
+        constexpr auto swar_equal_mask(swar_word_t<T> lhs, swar_word_t<T> rhs) noexcept
+            -> swar_word_t<T>
+        {
+            constexpr auto high = swar_high_bits<T>();
+            constexpr auto low = static_cast<swar_word_t<T>>(~high);
+            // Most significant bit set in halves which aren't zero
+            auto diff = static_cast<swar_word_t<T>>(lhs ^ rhs);
+            auto non_zero = static_cast<swar_word_t<T>>(((diff & low) + low) | diff);
+            return swar_expand<T>(static_cast<swar_word_t<T>>(~non_zero & high));
+        }
+
+        template<typename T>
+        constexpr auto swar_add_sat(swar_word_t<T> lhs, swar_word_t<T> rhs) noexcept
+            -> swar_word_t<T>
+        {
+            // Halves which overflowed are saturated to all ones
+            auto sum = swar_add<T>(lhs, rhs);
+            auto carries = (lhs & rhs) | ((lhs | rhs) & ~sum);
+            return static_cast<swar_word_t<T>>(
+                sum | swar_expand<T>(static_cast<swar_word_t<T>>(carries & swar_high_bits<T>()))
+            );
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Apply an element-wise operation to a pair, falling back
+        // to per-element operations when the pair can't be packed
+
+        template<typename T, typename PackedOp, typename ElementOp>
+        constexpr auto swar_apply(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs,
+                                  PackedOp packed_op, ElementOp element_op)
+            -> tight_pair<T, T>
+        {
+            static_assert(std::is_unsigned_v<T> && not std::is_same_v<std::remove_cv_t<T>, bool>,
+                          "SWAR operations are only available for pairs of unsigned integers");
+
+            if constexpr (can_use_swar<T>::value) {
+                return from_twice_as_big<T>(
+                    packed_op(get_twice_as_big(lhs), get_twice_as_big(rhs))
+                );
+            } else {
+                using cruft::get;
+                return tight_pair<T, T>(
+                    static_cast<T>(element_op(get<0>(lhs), get<0>(rhs))),
+                    static_cast<T>(element_op(get<1>(lhs), get<1>(rhs)))
+                );
+            }
+        }
+
+        template<typename InputIterator1, typename InputIterator2,
+                 typename OutputIterator, typename Operation>
+        constexpr auto swar_transform(InputIterator1 first1, InputIterator1 last1,
+                                      InputIterator2 first2, OutputIterator out,
+                                      Operation op)
+            -> OutputIterator
+        {
+            // Kept as simple as possible so that compilers can
+            // auto-vectorize it when given contiguous arrays
+            for (; first1 != last1; ++first1, (void) ++first2, (void) ++out) {
+                *out = op(*first1, *first2);
+            }
+            return out;
+        }
+    }
+
+    namespace swar
+    {
+        ////////////////////////////////////////////////////////////
+        // Element-wise operations on pairs of unsigned integers
+        //
+        // The arithmetic operations wrap around modulo 2^N where N
+        // is the number of bits of T, the masks have all the bits
+        // of an element set when the condition holds
+
+        template<typename T>
+        constexpr auto add(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) { return detail::swar_add<T>(x, y); },
+                [](T x, T y) { return x + y; }
+            );
+        }
+
+        template<typename T>
+        constexpr auto sub(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) { return detail::swar_sub<T>(x, y); },
+                [](T x, T y) { return x - y; }
+            );
+        }
+
+        template<typename T>
+        constexpr auto add_sat(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) { return detail::swar_add_sat<T>(x, y); },
+                [](T x, T y) { return static_cast<T>(x + y) < x ? static_cast<T>(-1) : static_cast<T>(x + y); }
+            );
+        }
+
+        template<typename T>
+        constexpr auto min(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) {
+                    auto mask = detail::swar_less_mask<T>(x, y);
+                    return static_cast<decltype(x)>((x & mask) | (y & ~mask));
+                },
+                [](T x, T y) { return y < x ? y : x; }
+            );
+        }
+
+        template<typename T>
+        constexpr auto max(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) {
+                    auto mask = detail::swar_less_mask<T>(x, y);
+                    return static_cast<decltype(x)>((y & mask) | (x & ~mask));
+                },
+                [](T x, T y) { return x < y ? y : x; }
+            );
+        }
+
+        template<typename T>
+        constexpr auto equal_mask(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) { return detail::swar_equal_mask<T>(x, y); },
+                [](T x, T y) { return x == y ? static_cast<T>(-1) : T(0); }
+            );
+        }
+
+        template<typename T>
+        constexpr auto less_mask(tight_pair<T, T> const& lhs, tight_pair<T, T> const& rhs) noexcept
+            -> tight_pair<T, T>
+        {
+            return detail::swar_apply(
+                lhs, rhs,
+                [](auto x, auto y) { return detail::swar_less_mask<T>(x, y); },
+                [](T x, T y) { return x < y ? static_cast<T>(-1) : T(0); }
+            );
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Batch versions: apply the operation to [first1, last1)
+        // and the range starting at first2, write the results to
+        // out and return the end of the output range
+
+#define CRUFT_TIGHT_PAIR_SWAR_BATCH(name)                                                   \
+        template<typename InputIterator1, typename InputIterator2, typename OutputIterator> \
+        constexpr auto name(InputIterator1 first1, InputIterator1 last1,                    \
+                            InputIterator2 first2, OutputIterator out)                      \
+            -> OutputIterator                                                               \
+        {                                                                                   \
+            return detail::swar_transform(                                                  \
+                first1, last1, first2, out,                                                 \
+                [](auto const& lhs, auto const& rhs) { return swar::name(lhs, rhs); }       \
+            );                                                                              \
+        }
+
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(add)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(sub)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(add_sat)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(min)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(max)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(equal_mask)
+        CRUFT_TIGHT_PAIR_SWAR_BATCH(less_mask)
+
+#undef CRUFT_TIGHT_PAIR_SWAR_BATCH
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_SWAR_H_
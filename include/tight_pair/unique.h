@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef CRUFT_TIGHT_PAIR_UNIQUE_H_
+#define CRUFT_TIGHT_PAIR_UNIQUE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "../tight_pair.h"
+#include "detail/packed_key.h"
+
+namespace cruft
+{
+    ////////////////////////////////////////////////////////////
+    // Result of unique_packed: the new end of the range and the
+    // number of removed elements
+
+    template<typename ForwardIterator>
+    struct unique_result
+    {
+        ForwardIterator last;
+        std::size_t duplicates;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Remove consecutive duplicates like std::unique, and report
+    // how many elements were removed
+    //
+    // With random-access iterators over packable pairs, adjacent
+    // elements are compared as packed integers and every element
+    // is unconditionally written at the current output position,
+    // which only advances when the element differs from the
+    // previous one: the loop has no data-dependent branch
+
+    template<typename ForwardIterator>
+    auto unique_packed(ForwardIterator first, ForwardIterator last)
+        -> unique_result<ForwardIterator>
+    {
+        using value_type = typename std::iterator_traits<ForwardIterator>::value_type;
+        using category = typename std::iterator_traits<ForwardIterator>::iterator_category;
+        using adapter = detail::packed_key_adapter<value_type, std::less<>>;
+
+        if (first == last) {
+            return { last, 0 };
+        }
+
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category> && adapter::is_packed) {
+            using difference_type = typename std::iterator_traits<ForwardIterator>::difference_type;
+
+            difference_type size = last - first;
+            difference_type out = 1;
+            auto previous = adapter::to_key(first[0]);
+            for (difference_type i = 1 ; i < size ; ++i) {
+                auto key = adapter::to_key(first[i]);
+                first[out] = adapter::from_key(key);
+                out += (key != previous);
+                previous = key;
+            }
+            return { first + out, static_cast<std::size_t>(size - out) };
+        } else {
+            std::size_t duplicates = 0;
+            auto out = first;
+            for (auto it = std::next(first) ; it != last ; ++it) {
+                if (*it == *out) {
+                    ++duplicates;
+                } else if (++out != it) {
+                    *out = std::move(*it);
+                }
+            }
+            return { std::next(out), duplicates };
+        }
+    }
+}
+
+#endif // CRUFT_TIGHT_PAIR_UNIQUE_H_
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/bloom_filter.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    auto random_pairs(std::size_t size, std::mt19937_64& engine)
+        -> std::vector<pair_t>
+    {
+        std::vector<pair_t> res;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            auto value = engine();
+            res.emplace_back(std::uint32_t(value), std::uint32_t(value >> 32));
+        }
+        return res;
+    }
+
+    // Only 32 bits of hash, like std::size_t on 32-bit platforms
+    struct narrow_hash
+    {
+        auto operator()(pair_t const& value) const noexcept
+            -> std::uint32_t
+        {
+            return static_cast<std::uint32_t>(cruft::pair_hash{}(value));
+        }
+    };
+}
+
+TEST_CASE( "test pair_bloom_filter lookups" )
+{
+    std::mt19937_64 engine(0x5eed);
+    auto keys = random_pairs(10'000, engine);
+    auto others = random_pairs(100'000, engine);
+
+    cruft::pair_bloom_filter<std::uint32_t, std::uint32_t> filter(keys.size());
+    CHECK_FALSE( filter.contains(keys[0]) );
+    filter.insert(keys.begin(), keys.end());
+
+    SECTION( "no false negatives" )
+    {
+        bool all_found = true;
+        for (auto const& key: keys) {
+            all_found &= filter.contains(key);
+        }
+        CHECK( all_found );
+    }
+
+    SECTION( "false positive rate" )
+    {
+        std::size_t false_positives = 0;
+        for (auto const& key: others) {
+            false_positives += filter.contains(key);
+        }
+        // About 1% expected with 10 bits per element
+        CHECK( false_positives < others.size() / 40 );
+    }
+
+    SECTION( "batched lookups" )
+    {
+        std::vector<pair_t> queries(keys.begin(), keys.begin() + 1000);
+        queries.insert(queries.end(), others.begin(), others.begin() + 1003);
+
+        std::vector<bool> expected;
+        for (auto const& query: queries) {
+            expected.push_back(filter.contains(query));
+        }
+        std::vector<bool> results;
+        filter.contains(queries.begin(), queries.end(), std::back_inserter(results));
+        CHECK( results == expected );
+    }
+
+    SECTION( "clear" )
+    {
+        filter.clear();
+        CHECK_FALSE( filter.contains(keys[0]) );
+    }
+}
+
+TEST_CASE( "test pair_bloom_filter with a 32-bit hash" )
+{
+    std::mt19937_64 engine(0x5eed);
+    auto keys = random_pairs(10'000, engine);
+    auto others = random_pairs(100'000, engine);
+
+    cruft::pair_bloom_filter<std::uint32_t, std::uint32_t, narrow_hash> filter(keys.size());
+    filter.insert(keys.begin(), keys.end());
+
+    // The keys are spread over all the blocks, not only the first one
+    std::size_t false_positives = 0;
+    for (auto const& key: others) {
+        false_positives += filter.contains(key);
+    }
+    CHECK( false_positives < others.size() / 40 );
+}
+
+#if CRUFT_TIGHT_PAIR_USE_UNSIGNED_128INT
+TEST_CASE( "test pair_bloom_filter with 128-bit packed keys" )
+{
+    using wide_pair_t = cruft::tight_pair<std::uint64_t, std::uint64_t>;
+
+    // Every key shares its second member, only the first members
+    // tell them apart
+    cruft::pair_bloom_filter<std::uint64_t, std::uint64_t> filter(10'000);
+    for (std::uint64_t i = 0 ; i < 10'000 ; ++i) {
+        filter.insert(wide_pair_t(i, 7u));
+    }
+
+    std::size_t false_positives = 0;
+    for (std::uint64_t i = 10'000 ; i < 110'000 ; ++i) {
+        false_positives += filter.contains(wide_pair_t(i, 7u));
+    }
+    CHECK( false_positives < 100'000 / 40 );
+}
+#endif
+
+TEST_CASE( "test pair_bloom_filter serialization" )
+{
+    std::mt19937_64 engine(0x5eed);
+    auto keys = random_pairs(5'000, engine);
+    auto others = random_pairs(5'000, engine);
+
+    cruft::pair_bloom_filter<std::uint32_t, std::uint32_t> filter(keys.size(), 8.0);
+    filter.insert(keys.begin(), keys.end());
+
+    std::stringstream stream;
+    CHECK( filter.write(stream) );
+    auto bytes = stream.str();
+    CHECK( bytes.size() == 8 + filter.size_in_bytes() );
+
+    SECTION( "round trip" )
+    {
+        auto copy = decltype(filter)::read(stream);
+        CHECK( copy.block_count() == filter.block_count() );
+        bool same = true;
+        for (auto const& key: keys) {
+            same &= copy.contains(key);
+        }
+        for (auto const& key: others) {
+            same &= (copy.contains(key) == filter.contains(key));
+        }
+        CHECK( same );
+    }
+
+    SECTION( "truncated input" )
+    {
+        std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+        CHECK_THROWS_AS( decltype(filter)::read(truncated), std::runtime_error );
+        std::istringstream empty;
+        CHECK_THROWS_AS( decltype(filter)::read(empty), std::runtime_error );
+    }
+}
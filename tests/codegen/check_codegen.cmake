@@ -0,0 +1,119 @@
+# Copyright (c) 2021 Morwenn
+# SPDX-License-Identifier: MIT
+
+# Compiles codegen.cpp with the given compiler at -O2, then
+# disassembles the object file and checks every function listed
+# in a codegen comment of the source file against its budget.
+# Functions listed in a codegen-byteswap comment instead have to
+# be reported as containing a byte swap:
+#
+#     cmake -DCOMPILER=<c++> -DOBJDUMP=<objdump> -DSOURCE=<codegen.cpp>
+#           -DINCLUDE_DIR=<include> -DOBJECT=<output.o> -P check_codegen.cmake
+
+cmake_minimum_required(VERSION 3.11.0)
+
+foreach (variable COMPILER OBJDUMP SOURCE INCLUDE_DIR OBJECT)
+    if (NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is not defined")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${COMPILER} -std=c++17 -O2 -c -I${INCLUDE_DIR} ${SOURCE} -o ${OBJECT}
+    RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "could not compile ${SOURCE} with ${COMPILER}")
+endif()
+
+execute_process(
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${OBJECT}
+    OUTPUT_VARIABLE disassembly
+    RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "could not disassemble ${OBJECT} with ${OBJDUMP}")
+endif()
+
+# Sort the instructions by function, ignoring the padding
+# between functions
+string(REPLACE ";" "\;" disassembly "${disassembly}")
+string(REPLACE "\n" ";" lines "${disassembly}")
+set(function "")
+set(functions "")
+foreach (line IN LISTS lines)
+    if (line MATCHES "^[0-9a-f]+ <([A-Za-z0-9_]+)>:$")
+        set(function ${CMAKE_MATCH_1})
+        list(APPEND functions ${function})
+        set(instructions_${function} "")
+    elseif (function AND line MATCHES "^ *[0-9a-f]+:[ \t]+(.+)$")
+        set(instruction "${CMAKE_MATCH_1}")
+        string(STRIP "${instruction}" instruction)
+        if (NOT instruction MATCHES "nop|^xchg +%ax,%ax$|^int3$")
+            list(APPEND instructions_${function} "${instruction}")
+        endif()
+    endif()
+endforeach()
+
+file(STRINGS ${SOURCE} budgets REGEX "// codegen(-byteswap)?: ")
+set(rejected "")
+foreach (budget IN LISTS budgets)
+    if (budget MATCHES "// codegen-byteswap: ([A-Za-z0-9_]+)")
+        list(APPEND rejected ${CMAKE_MATCH_1})
+    endif()
+endforeach()
+
+set(failures 0)
+foreach (budget IN LISTS budgets)
+    string(REGEX MATCH "// codegen(-byteswap)?: ([A-Za-z0-9_]+) ([0-9]+)" _ "${budget}")
+    set(name ${CMAKE_MATCH_2})
+    set(max_instructions ${CMAKE_MATCH_3})
+
+    if (NOT name IN_LIST functions)
+        message(SEND_ERROR "${name}: not found in the object code")
+        math(EXPR failures "${failures} + 1")
+        continue()
+    endif()
+
+    set(errors "")
+    list(LENGTH instructions_${name} count)
+    if (count GREATER max_instructions)
+        list(APPEND errors "${count} instructions, budget is ${max_instructions}")
+    endif()
+    foreach (instruction IN LISTS instructions_${name})
+        if (instruction MATCHES "^j" AND NOT instruction MATCHES "^jmp")
+            list(APPEND errors "conditional jump: ${instruction}")
+        elseif (instruction MATCHES "^(bswap|movbe)"
+                # 16-bit byte swaps are rotations by 8 bits...
+                OR instruction MATCHES "^(rol|ror)w[ \t]+\\$(0x)?8,"
+                OR instruction MATCHES "^(rol|ror)[ \t]+\\$(0x)?8, ?%([abcd]x|[sd]i|[sb]p|r[0-9]+w)$"
+                # ...or exchanges of the two bytes of a register
+                OR instruction MATCHES "^xchgb?[ \t]+%[abcd][hl], ?%[abcd][hl]$")
+            list(APPEND errors "byte swap: ${instruction}")
+        elseif (instruction MATCHES "^call")
+            list(APPEND errors "call: ${instruction}")
+        endif()
+    endforeach()
+
+    # Functions checking the checks themselves have to be rejected
+    if (name IN_LIST rejected)
+        if (NOT errors MATCHES "byte swap")
+            string(REPLACE ";" "\n    " listing "${instructions_${name}}")
+            message(SEND_ERROR "${name}: byte swap not detected\n  object code:\n    ${listing}")
+            math(EXPR failures "${failures} + 1")
+        else()
+            message(STATUS "${name}: byte swap detected")
+        endif()
+    elseif (errors)
+        string(REPLACE ";" "\n    " errors "${errors}")
+        string(REPLACE ";" "\n    " listing "${instructions_${name}}")
+        message(SEND_ERROR "${name}:\n    ${errors}\n  object code:\n    ${listing}")
+        math(EXPR failures "${failures} + 1")
+    else()
+        message(STATUS "${name}: ${count} instructions")
+    endif()
+endforeach()
+
+if (failures GREATER 0)
+    message(FATAL_ERROR "${failures} function(s) over their codegen budget with ${COMPILER}")
+endif()
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstdint>
+#include <tight_pair.h>
+
+////////////////////////////////////////////////////////////
+// Representative instantiations whose object code is checked
+// by check_codegen.cmake: every function listed in a codegen
+// comment must be free of conditional jumps, byte swaps and
+// calls, and must not exceed the given number of instructions,
+// including the final ret. Only pairs of identical unsigned
+// integers are packed, other pairs legitimately branch
+//
+// Functions in a codegen-byteswap comment deliberately swap
+// bytes, to make sure that the byte swaps are detected
+
+namespace
+{
+    struct empty {};
+}
+
+using u8_pair = cruft::tight_pair<std::uint8_t, std::uint8_t>;
+using u16_pair = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+using u32_pair = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+using empty_pair = cruft::tight_pair<empty, std::uint32_t>;
+
+extern "C"
+{
+    ////////////////////////////////////////////////////////////
+    // Comparisons
+
+    // codegen: less_u8 5
+    auto less_u8(u8_pair const& lhs, u8_pair const& rhs)
+        -> bool
+    {
+        return lhs < rhs;
+    }
+
+    // codegen: less_u16 5
+    auto less_u16(u16_pair const& lhs, u16_pair const& rhs)
+        -> bool
+    {
+        return lhs < rhs;
+    }
+
+    // codegen: less_u32 5
+    auto less_u32(u32_pair const& lhs, u32_pair const& rhs)
+        -> bool
+    {
+        return lhs < rhs;
+    }
+
+    // codegen: greater_equal_u16 5
+    auto greater_equal_u16(u16_pair const& lhs, u16_pair const& rhs)
+        -> bool
+    {
+        return lhs >= rhs;
+    }
+
+    // codegen: equal_u8 5
+    auto equal_u8(u8_pair const& lhs, u8_pair const& rhs)
+        -> bool
+    {
+        return lhs == rhs;
+    }
+
+    // codegen: equal_u16 5
+    auto equal_u16(u16_pair const& lhs, u16_pair const& rhs)
+        -> bool
+    {
+        return lhs == rhs;
+    }
+
+    // codegen: equal_u32 5
+    auto equal_u32(u32_pair const& lhs, u32_pair const& rhs)
+        -> bool
+    {
+        return lhs == rhs;
+    }
+
+    // codegen: not_equal_u16 5
+    auto not_equal_u16(u16_pair const& lhs, u16_pair const& rhs)
+        -> bool
+    {
+        return lhs != rhs;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Swap
+
+    // codegen: swap_u16 6
+    auto swap_u16(u16_pair& lhs, u16_pair& rhs)
+        -> void
+    {
+        swap(lhs, rhs);
+    }
+
+    // codegen: swap_u32 6
+    auto swap_u32(u32_pair& lhs, u32_pair& rhs)
+        -> void
+    {
+        swap(lhs, rhs);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Element access
+
+    // codegen: get_first_u16 3
+    auto get_first_u16(u16_pair const& value)
+        -> std::uint16_t
+    {
+        return cruft::get<0>(value);
+    }
+
+    // codegen: get_second_u16 3
+    auto get_second_u16(u16_pair const& value)
+        -> std::uint16_t
+    {
+        return cruft::get<1>(value);
+    }
+
+    // codegen: get_second_empty 3
+    auto get_second_empty(empty_pair const& value)
+        -> std::uint32_t
+    {
+        return cruft::get<1>(value);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Checks of the checks: 16-bit byte swaps are rotations
+
+    // codegen-byteswap: byteswap_first_u16 3
+    auto byteswap_first_u16(u16_pair const& value)
+        -> std::uint16_t
+    {
+        auto first = cruft::get<0>(value);
+        return static_cast<std::uint16_t>((first << 8) | (first >> 8));
+    }
+
+    // codegen-byteswap: byteswap_second_u16_in_place 3
+    auto byteswap_second_u16_in_place(u16_pair& value)
+        -> void
+    {
+        auto& second = cruft::get<1>(value);
+        second = static_cast<std::uint16_t>((second << 8) | (second >> 8));
+    }
+}
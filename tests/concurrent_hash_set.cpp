@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/concurrent_hash_set.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    struct std_pair_hash
+    {
+        auto operator()(pair_t const& value) const noexcept
+            -> std::size_t
+        {
+            return cruft::pair_hash{}(value);
+        }
+    };
+}
+
+TEST_CASE( "test concurrent_pair_set against std::unordered_set" )
+{
+    std::mt19937_64 engine(0x5eed);
+    // Small initial capacity to go through several resizes
+    cruft::concurrent_pair_set<std::uint32_t, std::uint32_t> set(16);
+    std::unordered_set<pair_t, std_pair_hash> reference;
+
+    for (int i = 0 ; i < 20'000 ; ++i) {
+        pair_t key(std::uint32_t(engine() % 128), std::uint32_t(engine() % 128));
+        CHECK( set.insert(key) == reference.insert(key).second );
+    }
+    CHECK( set.size() == reference.size() );
+    CHECK( set.capacity() >= 2 * set.size() );
+
+    for (std::uint32_t i = 0 ; i < 130 ; ++i) {
+        for (std::uint32_t j = 0 ; j < 130 ; ++j) {
+            pair_t key(i, j);
+            CHECK( set.contains(key) == (reference.count(key) != 0) );
+        }
+    }
+
+    SECTION( "keys matching the sentinel words" )
+    {
+        constexpr auto max = std::numeric_limits<std::uint32_t>::max();
+        pair_t all_ones(max, max);
+
+        // (0, 0) is in the set already
+        CHECK( set.contains(pair_t(0, 0)) );
+        CHECK_FALSE( set.insert(pair_t(0, 0)) );
+
+        CHECK_FALSE( set.contains(all_ones) );
+        CHECK( set.insert(all_ones) );
+        CHECK( set.contains(all_ones) );
+        CHECK_FALSE( set.insert(all_ones) );
+        CHECK( set.size() == reference.size() + 1 );
+    }
+}
+
+TEST_CASE( "test concurrent_pair_set with a fixed capacity" )
+{
+    cruft::concurrent_pair_set<std::uint32_t, std::uint32_t> set(8, cruft::resize_policy::fixed);
+    auto capacity = set.capacity();
+
+    // The whole table can be filled, then insertions throw
+    for (std::uint32_t i = 1 ; i <= capacity ; ++i) {
+        CHECK( set.insert(pair_t(i, i)) );
+    }
+    CHECK( set.capacity() == capacity );
+    CHECK_FALSE( set.insert(pair_t(1, 1)) );
+    CHECK_THROWS_AS( set.insert(pair_t(0, 1)), std::length_error );
+}
+
+TEST_CASE( "test concurrent insertions in concurrent_pair_set" )
+{
+    constexpr std::uint32_t nb_keys = 100'000;
+    constexpr int nb_threads = 4;
+
+    cruft::concurrent_pair_set<std::uint32_t, std::uint32_t> set(64);
+    std::atomic<std::uint32_t> nb_inserted(0);
+
+    // Every thread inserts every key in a different order, so that
+    // the same key is inserted concurrently while tables are resized
+    std::vector<std::thread> threads;
+    for (int t = 0 ; t < nb_threads ; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<pair_t> keys;
+            keys.reserve(nb_keys);
+            for (std::uint32_t i = 0 ; i < nb_keys ; ++i) {
+                keys.emplace_back(i % 1000, i / 1000);
+            }
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(t));
+
+            std::uint32_t inserted = 0;
+            for (auto const& key: keys) {
+                inserted += set.insert(key);
+                if (not set.contains(key)) {
+                    // Avoid Catch2 macros in threads
+                    inserted = nb_keys + 1;
+                }
+            }
+            nb_inserted += inserted;
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    CHECK( nb_inserted == nb_keys );
+    CHECK( set.size() == nb_keys );
+    bool all_found = true;
+    for (std::uint32_t i = 0 ; i < nb_keys ; ++i) {
+        all_found &= set.contains(pair_t(i % 1000, i / 1000));
+    }
+    CHECK( all_found );
+    CHECK_FALSE( set.contains(pair_t(1000, 0)) );
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/convert.h>
+
+TEST_CASE( "test bulk conversion between std::pair and tight_pair" )
+{
+    using cruft::get;
+
+    SECTION( "packed unsigned integers" )
+    {
+        std::vector<std::pair<std::uint16_t, std::uint16_t>> pairs;
+        for (std::uint16_t i = 0 ; i < 1000 ; ++i) {
+            pairs.emplace_back(i, std::uint16_t(2000 - i));
+        }
+
+        std::vector<cruft::tight_pair<std::uint16_t, std::uint16_t>> tight_pairs(pairs.size());
+        auto end = cruft::convert(pairs.data(), pairs.data() + pairs.size(), tight_pairs.data());
+        CHECK( end == tight_pairs.data() + tight_pairs.size() );
+        for (std::size_t i = 0 ; i < pairs.size() ; ++i) {
+            CHECK( get<0>(tight_pairs[i]) == pairs[i].first );
+            CHECK( get<1>(tight_pairs[i]) == pairs[i].second );
+        }
+
+        std::vector<std::pair<std::uint16_t, std::uint16_t>> back(pairs.size());
+        cruft::convert(tight_pairs.data(), tight_pairs.data() + tight_pairs.size(), back.data());
+        CHECK( back == pairs );
+    }
+
+    SECTION( "non-trivial types" )
+    {
+        std::vector<std::pair<std::string, int>> pairs = {
+            { "foo", 1 }, { "bar", 2 }, { "baz", 3 }
+        };
+
+        std::vector<cruft::tight_pair<std::string, int>> tight_pairs(pairs.size());
+        cruft::convert(pairs.data(), pairs.data() + pairs.size(), tight_pairs.data());
+        CHECK( get<0>(tight_pairs[1]) == "bar" );
+        CHECK( get<1>(tight_pairs[2]) == 3 );
+    }
+}
+
+TEST_CASE( "test in-place conversion between std::pair and tight_pair" )
+{
+    using cruft::get;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    for (std::uint32_t i = 0 ; i < 1000 ; ++i) {
+        pairs.emplace_back(i, 0xffffffffu - i);
+    }
+
+    auto tight_pairs = cruft::convert_in_place(pairs.data(), pairs.data() + pairs.size());
+    for (std::uint32_t i = 0 ; i < 1000 ; ++i) {
+        CHECK( get<0>(tight_pairs[i]) == i );
+        CHECK( get<1>(tight_pairs[i]) == 0xffffffffu - i );
+    }
+
+    auto std_pairs = cruft::convert_in_place(tight_pairs, tight_pairs + 1000);
+    for (std::uint32_t i = 0 ; i < 1000 ; ++i) {
+        CHECK( std_pairs[i].first == i );
+        CHECK( std_pairs[i].second == 0xffffffffu - i );
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/dary_heap.h>
+
+namespace
+{
+    template<typename Heap, typename Compare=std::less<>>
+    auto check_heap_order(Compare compare={})
+        -> void
+    {
+        using pair_t = typename Heap::value_type;
+
+        std::mt19937_64 engine(0x5eed);
+        Heap heap;
+        std::vector<pair_t> reference;
+
+        // Interleave pushes and pops to exercise the padding of
+        // the last group of children
+        for (int round = 0 ; round < 20 ; ++round) {
+            auto nb_push = engine() % 200;
+            for (std::size_t i = 0 ; i < nb_push ; ++i) {
+                pair_t value(std::uint32_t(engine() % 50), std::uint32_t(engine()));
+                heap.push(value);
+                reference.push_back(value);
+            }
+            std::sort(reference.begin(), reference.end(), compare);
+            auto nb_pop = std::min<std::size_t>(engine() % 200, reference.size());
+            for (std::size_t i = 0 ; i < nb_pop ; ++i) {
+                REQUIRE( heap.top() == reference.front() );
+                heap.pop();
+                reference.erase(reference.begin());
+            }
+            REQUIRE( heap.size() == reference.size() );
+        }
+
+        while (not heap.empty()) {
+            REQUIRE( heap.top() == reference.front() );
+            heap.pop();
+            reference.erase(reference.begin());
+        }
+        CHECK( reference.empty() );
+    }
+}
+
+TEST_CASE( "test d-ary heap order" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    using mixed_pair_t = cruft::tight_pair<std::uint32_t, std::uint64_t>;
+
+    SECTION( "packed keys" )
+    {
+        check_heap_order<cruft::dary_heap<pair_t, 2>>();
+        check_heap_order<cruft::dary_heap<pair_t, 4>>();
+        check_heap_order<cruft::dary_heap<pair_t, 8>>();
+        check_heap_order<cruft::dary_heap<pair_t, 8, std::greater<>>>(std::greater<>{});
+    }
+
+    SECTION( "unpacked keys" )
+    {
+        check_heap_order<cruft::dary_heap<mixed_pair_t, 3>>();
+        check_heap_order<cruft::dary_heap<mixed_pair_t, 4, std::greater<>>>(std::greater<>{});
+    }
+}
+
+TEST_CASE( "test d-ary heap with maximal keys" )
+{
+    // Elements equal to the padding sentinel must still be found
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    constexpr auto max = std::uint32_t(-1);
+
+    cruft::dary_heap<pair_t, 8> heap;
+    heap.push({ max, max });
+    heap.push({ max, max });
+    heap.push({ 0u, 0u });
+    CHECK( heap.top() == pair_t(0u, 0u) );
+    heap.pop();
+    CHECK( heap.top() == pair_t(max, max) );
+    heap.pop();
+    CHECK( heap.top() == pair_t(max, max) );
+    heap.pop();
+    CHECK( heap.empty() );
+}
+
+TEST_CASE( "test d-ary heap decrease_key" )
+{
+    SECTION( "packed keys" )
+    {
+        using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+        cruft::dary_heap<pair_t, 8> heap;
+        for (std::uint32_t i = 10 ; i < 100 ; ++i) {
+            heap.push({ i, i * 2 });
+        }
+        CHECK( heap.find({ 5u, 10u }) == heap.size() );
+
+        auto pos = heap.find({ 75u, 150u });
+        REQUIRE( pos < heap.size() );
+        CHECK( heap[pos] == pair_t(75u, 150u) );
+        heap.decrease_key(pos, { 5u, 150u });
+        CHECK( heap.find({ 75u, 150u }) == heap.size() );
+        CHECK( heap.top() == pair_t(5u, 150u) );
+        heap.pop();
+        CHECK( heap.top() == pair_t(10u, 20u) );
+        CHECK( heap.size() == 89 );
+    }
+
+    SECTION( "unpacked keys" )
+    {
+        using pair_t = cruft::tight_pair<int, std::string>;
+
+        cruft::dary_heap<pair_t, 4> heap;
+        for (int i = 10 ; i < 30 ; ++i) {
+            heap.push({ i, std::to_string(i) });
+        }
+        CHECK( heap.find({ 25, "26" }) == heap.size() );
+
+        auto pos = heap.find({ 25, "25" });
+        REQUIRE( pos < heap.size() );
+        heap.decrease_key(pos, { 5, "25" });
+        CHECK( heap.top() == pair_t(5, "25") );
+        heap.pop();
+        CHECK( heap.top() == pair_t(10, "10") );
+        CHECK( heap.size() == 19 );
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/external_sort.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    auto make_pairs(std::size_t size)
+        -> std::vector<pair_t>
+    {
+        std::mt19937_64 engine(0x5eed);
+        std::vector<pair_t> pairs;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            // Few different first elements to get duplicates
+            pairs.emplace_back(std::uint32_t(engine() % 100), std::uint32_t(engine()));
+        }
+        pairs.emplace_back(0xffffffffu, 0xffffffffu);
+        pairs.emplace_back(0u, 0u);
+        return pairs;
+    }
+}
+
+// Every check can throw while a sorter is alive: GCC doesn't inline
+// ~external_sorter on those unwinding paths and reports it with -Winline
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic ignored "-Winline"
+#endif
+
+TEST_CASE( "test external sort" )
+{
+    auto pairs = make_pairs(100'000);
+    auto expected = pairs;
+    std::sort(expected.begin(), expected.end());
+
+    SECTION( "everything fits in memory" )
+    {
+        cruft::external_sorter<std::uint32_t, std::uint32_t> sorter;
+        std::copy(pairs.begin(), pairs.end(), sorter.sink());
+        CHECK( sorter.run_count() == 0 );
+
+        std::vector<pair_t> res;
+        sorter.finish(std::back_inserter(res));
+        CHECK( res == expected );
+    }
+
+    SECTION( "single merge pass" )
+    {
+        cruft::external_sort_options options;
+        options.memory_budget = 64 * 1024;
+        cruft::external_sorter<std::uint32_t, std::uint32_t> sorter(options);
+        for (auto const& pair: pairs) {
+            sorter.push(pair);
+        }
+        CHECK( sorter.run_count() > 1 );
+
+        std::vector<pair_t> res;
+        sorter.finish(std::back_inserter(res));
+        CHECK( res == expected );
+    }
+
+    SECTION( "several merge passes" )
+    {
+        // The budget only allows to merge two runs at once
+        cruft::external_sort_options options;
+        options.memory_budget = 2 * 1024 * 1024 + 7;
+        cruft::external_sorter<std::uint32_t, std::uint32_t> sorter(options);
+
+        auto big_pairs = make_pairs(1'000'000);
+        std::copy(big_pairs.begin(), big_pairs.end(), sorter.sink());
+        CHECK( sorter.run_count() > 2 );
+
+        std::vector<pair_t> res;
+        sorter.finish(std::back_inserter(res));
+        std::sort(big_pairs.begin(), big_pairs.end());
+        CHECK( res == big_pairs );
+    }
+}
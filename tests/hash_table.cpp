@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/hash_table.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    struct std_pair_hash
+    {
+        auto operator()(pair_t const& value) const noexcept
+            -> std::size_t
+        {
+            return cruft::pair_hash{}(value);
+        }
+    };
+}
+
+TEST_CASE( "test pair_hash_set against std::unordered_map" )
+{
+    std::mt19937_64 engine(0x5eed);
+    cruft::pair_hash_set<std::uint32_t, std::uint32_t> set;
+    std::unordered_map<pair_t, int, std_pair_hash> reference;
+
+    // Small key space to get many duplicate insertions, erasures of
+    // existing keys and reuse of deleted slots
+    for (int i = 0 ; i < 50'000 ; ++i) {
+        pair_t key(std::uint32_t(engine() % 64), std::uint32_t(engine() % 64));
+        switch (engine() % 3) {
+            case 0:
+            case 1:
+                REQUIRE( set.insert(key) == reference.emplace(key, 0).second );
+                break;
+            case 2:
+                REQUIRE( set.erase(key) == (reference.erase(key) == 1) );
+                break;
+        }
+        REQUIRE( set.size() == reference.size() );
+    }
+
+    for (std::uint32_t first = 0 ; first < 64 ; ++first) {
+        for (std::uint32_t second = 0 ; second < 64 ; ++second) {
+            pair_t key(first, second);
+            CHECK( set.contains(key) == (reference.count(key) == 1) );
+        }
+    }
+
+    std::size_t count = 0;
+    set.for_each([&](pair_t const& key) {
+        ++count;
+        CHECK( reference.count(key) == 1 );
+    });
+    CHECK( count == reference.size() );
+    CHECK( set.capacity() >= set.size() );
+
+    set.clear();
+    CHECK( set.empty() );
+    CHECK( not set.contains(pair_t(0u, 0u)) );
+}
+
+#if CRUFT_TIGHT_PAIR_USE_UNSIGNED_128INT
+TEST_CASE( "test pair_hash_set with 128-bit packed keys" )
+{
+    using wide_pair_t = cruft::tight_pair<std::uint64_t, std::uint64_t>;
+
+    // Keys sharing their second member only differ by the half of
+    // the packed representation that doesn't fit in 64 bits
+    std::unordered_set<std::size_t> hashes;
+    cruft::pair_hash_set<std::uint64_t, std::uint64_t> set;
+    for (std::uint64_t i = 0 ; i < 10'000 ; ++i) {
+        wide_pair_t key(i, 7u);
+        hashes.insert(cruft::pair_hash{}(key));
+        REQUIRE( set.insert(key) );
+    }
+    CHECK( hashes.size() == 10'000 );
+    CHECK( set.size() == 10'000 );
+
+    bool all_found = true;
+    for (std::uint64_t i = 0 ; i < 10'000 ; ++i) {
+        all_found &= set.contains(wide_pair_t(i, 7u));
+    }
+    CHECK( all_found );
+    CHECK( not set.contains(wide_pair_t(7u, 7u + 1)) );
+}
+#endif
+
+TEST_CASE( "test pair_hash_map" )
+{
+    cruft::pair_hash_map<std::uint16_t, std::uint16_t, std::string> map;
+    using key_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+
+    map.reserve(1000);
+    auto capacity = map.capacity();
+    for (std::uint16_t i = 0 ; i < 1000 ; ++i) {
+        CHECK( map.insert(key_t(i, std::uint16_t(i * 3)), std::to_string(i)) );
+    }
+    CHECK( map.capacity() == capacity );
+    CHECK( map.size() == 1000 );
+
+    CHECK( not map.insert(key_t(5, 15), "other") );
+    CHECK( *map.find(key_t(5, 15)) == "5" );
+    CHECK( not map.insert_or_assign(key_t(5, 15), "other") );
+    CHECK( *map.find(key_t(5, 15)) == "other" );
+    CHECK( map.find(key_t(5, 16)) == nullptr );
+
+    map[key_t(2000, 0)] += "new";
+    CHECK( *map.find(key_t(2000, 0)) == "new" );
+    CHECK( map.size() == 1001 );
+
+    CHECK( map.erase(key_t(7, 21)) );
+    CHECK( map.find(key_t(7, 21)) == nullptr );
+
+    std::size_t count = 0;
+    map.for_each([&](key_t const& key, std::string& value) {
+        ++count;
+        if (cruft::get<0>(key) < 1000 && cruft::get<0>(key) != 5) {
+            CHECK( value == std::to_string(cruft::get<0>(key)) );
+        }
+    });
+    CHECK( count == 1000 );
+}
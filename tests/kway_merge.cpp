@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/kway_merge.h>
+#include <tight_pair/loser_tree.h>
+
+TEST_CASE( "test loser tree" )
+{
+    std::vector<std::vector<int>> sources = {
+        { 1, 4, 7, 10 },
+        {},
+        { 2, 2, 3 },
+        { 0, 5, 6, 8, 9 },
+        { 11 }
+    };
+    std::vector<std::size_t> positions(sources.size(), 0);
+
+    cruft::loser_tree<int> tree(sources.size());
+    for (std::size_t i = 0 ; i < sources.size() ; ++i) {
+        if (not sources[i].empty()) {
+            tree.set(i, sources[i][0]);
+        }
+    }
+    tree.build();
+
+    std::vector<int> res;
+    while (not tree.empty()) {
+        res.push_back(tree.winner_key());
+        auto& pos = positions[tree.winner()];
+        auto& source = sources[tree.winner()];
+        if (++pos < source.size()) {
+            tree.replace_winner(source[pos]);
+        } else {
+            tree.winner_done();
+        }
+    }
+    CHECK( res == std::vector<int>{ 0, 1, 2, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 } );
+}
+
+TEST_CASE( "test k-way merge of packed pairs" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    std::mt19937_64 engine(0x5eed);
+    for (std::size_t ways: { 0, 1, 2, 3, 7, 16, 100 }) {
+        std::vector<std::vector<pair_t>> ranges(ways);
+        std::vector<pair_t> expected;
+        for (auto& range: ranges) {
+            auto size = engine() % 50;
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                range.emplace_back(std::uint32_t(engine() % 10), std::uint32_t(engine()));
+            }
+            std::sort(range.begin(), range.end());
+            expected.insert(expected.end(), range.begin(), range.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<pair_t> res;
+        cruft::kway_merge(ranges, std::back_inserter(res));
+        CHECK( res == expected );
+
+        for (auto& range: ranges) {
+            std::reverse(range.begin(), range.end());
+        }
+        std::reverse(expected.begin(), expected.end());
+        res.clear();
+        cruft::kway_merge(ranges, std::back_inserter(res), std::greater<>{});
+        CHECK( res == expected );
+    }
+}
+
+TEST_CASE( "test k-way merge stability" )
+{
+    using pair_t = cruft::tight_pair<int, std::string>;
+
+    std::vector<std::list<pair_t>> ranges = {
+        { {1, "a"}, {3, "a"}, {5, "a"} },
+        { {1, "b"}, {2, "b"}, {5, "b"} },
+        { {1, "c"}, {3, "c"}, {4, "c"} }
+    };
+
+    std::vector<pair_t> res;
+    cruft::kway_merge(ranges, std::back_inserter(res), [](auto const& lhs, auto const& rhs) {
+        using cruft::get;
+        return get<0>(lhs) < get<0>(rhs);
+    });
+
+    std::vector<pair_t> expected = {
+        {1, "a"}, {1, "b"}, {1, "c"}, {2, "b"}, {3, "a"},
+        {3, "c"}, {4, "c"}, {5, "a"}, {5, "b"}
+    };
+    CHECK( res == expected );
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/merge.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    auto make_sorted_pairs(std::mt19937_64& engine, std::size_t size, std::uint32_t max_first)
+        -> std::vector<pair_t>
+    {
+        std::vector<pair_t> res;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            res.emplace_back(std::uint32_t(engine() % max_first), std::uint32_t(engine() % 3));
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+}
+
+TEST_CASE( "test merge and set operations against <algorithm>" )
+{
+    std::mt19937_64 engine(0x5eed);
+
+    // Balanced sizes use the branchless loops, very skewed sizes use galloping
+    std::pair<std::size_t, std::size_t> sizes[] = {
+        { 0, 0 }, { 0, 10 }, { 10, 0 }, { 100, 100 },
+        { 100, 10 }, { 10, 100 }, { 500, 3 }, { 3, 500 }, { 5000, 40 }, { 40, 5000 }
+    };
+    for (auto [size1, size2]: sizes) {
+        for (std::uint32_t max_first: { 5u, 1000u }) {
+            auto lhs = make_sorted_pairs(engine, size1, max_first);
+            auto rhs = make_sorted_pairs(engine, size2, max_first);
+
+            std::vector<pair_t> expected, res;
+            std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+            cruft::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res));
+            CHECK( res == expected );
+
+            expected.clear(); res.clear();
+            std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+            cruft::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res));
+            CHECK( res == expected );
+
+            expected.clear(); res.clear();
+            std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+            cruft::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res));
+            CHECK( res == expected );
+
+            std::reverse(lhs.begin(), lhs.end());
+            std::reverse(rhs.begin(), rhs.end());
+            expected.clear(); res.clear();
+            std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                std::back_inserter(expected), std::greater<>{});
+            cruft::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                  std::back_inserter(res), std::greater<>{});
+            CHECK( res == expected );
+        }
+    }
+}
+
+TEST_CASE( "test merge stability with a custom comparison" )
+{
+    using pair_t = cruft::tight_pair<int, std::string>;
+    auto compare = [](pair_t const& lhs, pair_t const& rhs) {
+        using cruft::get;
+        return get<0>(lhs) < get<0>(rhs);
+    };
+
+    std::vector<pair_t> lhs = { {1, "a"}, {2, "a"}, {2, "b"} };
+    std::list<pair_t> rhs = { {1, "c"}, {2, "c"}, {3, "c"} };
+    std::vector<pair_t> expected = {
+        {1, "a"}, {1, "c"}, {2, "a"}, {2, "b"}, {2, "c"}, {3, "c"}
+    };
+
+    std::vector<pair_t> res;
+    cruft::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res), compare);
+    CHECK( res == expected );
+
+    std::vector<pair_t> rhs_vec(rhs.begin(), rhs.end());
+    res.clear();
+    cruft::merge(lhs.begin(), lhs.end(), rhs_vec.begin(), rhs_vec.end(), std::back_inserter(res), compare);
+    CHECK( res == expected );
+}
+
+TEST_CASE( "test merge_join_on_first" )
+{
+    using left_t = cruft::tight_pair<int, char>;
+    using right_t = cruft::tight_pair<int, std::string>;
+
+    std::vector<left_t> left = { {1, 'a'}, {2, 'b'}, {2, 'c'}, {4, 'd'}, {6, 'e'} };
+    std::vector<right_t> right = { {0, "x"}, {2, "y"}, {2, "z"}, {3, "w"}, {6, "v"}, {7, "u"} };
+
+    std::vector<std::string> res;
+    auto join = [&](left_t const& lhs, right_t const& rhs) {
+        using cruft::get;
+        res.push_back(std::to_string(get<0>(lhs)) + get<1>(lhs) + get<1>(rhs));
+    };
+
+    cruft::merge_join_on_first(left, right, join);
+    std::vector<std::string> expected = { "2by", "2bz", "2cy", "2cz", "6ev" };
+    CHECK( res == expected );
+
+    // Same result with bidirectional iterators
+    res.clear();
+    std::list<left_t> left_list(left.begin(), left.end());
+    cruft::merge_join_on_first(left_list, right, join);
+    CHECK( res == expected );
+
+    // Skewed sizes
+    std::vector<right_t> big_right;
+    for (int i = 0 ; i < 1000 ; ++i) {
+        big_right.emplace_back(i, "");
+    }
+    res.clear();
+    cruft::merge_join_on_first(left, big_right, join);
+    CHECK( res == std::vector<std::string>{ "1a", "2b", "2c", "4d", "6e" } );
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/morton.h>
+
+namespace
+{
+    template<typename T>
+    auto check_morton_roundtrip()
+        -> void
+    {
+        using pair_t = cruft::tight_pair<T, T>;
+        constexpr auto max = std::numeric_limits<T>::max();
+
+        std::mt19937_64 engine(0x5eed);
+        std::uniform_int_distribution<std::uint64_t> dist(0, max);
+        for (int i = 0 ; i < 1000 ; ++i) {
+            pair_t pair(T(dist(engine)), T(dist(engine)));
+            auto code = cruft::morton_encode(pair);
+            CHECK( cruft::morton_decode<T>(code) == pair );
+        }
+
+        CHECK( cruft::morton_encode(pair_t(0, 0)) == 0 );
+        CHECK( cruft::morton_encode(pair_t(max, max)) == static_cast<decltype(cruft::morton_encode(pair_t()))>(-1) );
+        CHECK( cruft::morton_decode<T>(cruft::morton_encode(pair_t(max, 0))) == pair_t(max, 0) );
+    }
+}
+
+TEST_CASE( "test Morton code values" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    CHECK( cruft::morton_encode(pair_t(0, 1)) == 0b01u );
+    CHECK( cruft::morton_encode(pair_t(1, 0)) == 0b10u );
+    CHECK( cruft::morton_encode(pair_t(1, 1)) == 0b11u );
+    CHECK( cruft::morton_encode(pair_t(0b101, 0b011)) == 0b100111u );
+    CHECK( cruft::morton_encode(pair_t(0xffffffff, 0)) == 0xaaaaaaaaaaaaaaaau );
+    CHECK( cruft::morton_encode(pair_t(0, 0xffffffff)) == 0x5555555555555555u );
+
+    static_assert(cruft::detail::morton_spread_magic(0xffffffffu) == 0x5555555555555555u);
+    static_assert(cruft::detail::morton_compact_magic(0x5555555555555555u) == 0xffffffffu);
+}
+
+TEST_CASE( "test Morton code roundtrip" )
+{
+    SECTION( "std::uint8_t" )
+    {
+        check_morton_roundtrip<std::uint8_t>();
+    }
+
+    SECTION( "std::uint16_t" )
+    {
+        check_morton_roundtrip<std::uint16_t>();
+    }
+
+    SECTION( "std::uint32_t" )
+    {
+        check_morton_roundtrip<std::uint32_t>();
+    }
+
+#if CRUFT_TIGHT_PAIR_USE_UNSIGNED_128INT && defined(__SIZEOF_INT128__)
+    SECTION( "std::uint64_t" )
+    {
+        check_morton_roundtrip<std::uint64_t>();
+    }
+#endif
+}
+
+TEST_CASE( "test Z-order sort" )
+{
+    using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+
+    // 4x4 grid sorted along a Z-order curve
+    std::vector<pair_t> points;
+    for (std::uint16_t x = 0 ; x < 4 ; ++x) {
+        for (std::uint16_t y = 0 ; y < 4 ; ++y) {
+            points.emplace_back(x, y);
+        }
+    }
+    std::sort(points.begin(), points.end(), cruft::morton_less{});
+
+    std::vector<pair_t> expected = {
+        {0, 0}, {0, 1}, {1, 0}, {1, 1},
+        {0, 2}, {0, 3}, {1, 2}, {1, 3},
+        {2, 0}, {2, 1}, {3, 0}, {3, 1},
+        {2, 2}, {2, 3}, {3, 2}, {3, 3}
+    };
+    CHECK( points == expected );
+
+    cruft::morton_key key;
+    CHECK( std::is_sorted(points.begin(), points.end(), [&](auto const& lhs, auto const& rhs) {
+        return key(lhs) < key(rhs);
+    }) );
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+
+namespace
+{
+    struct empty {};
+    struct other_empty {};
+
+    struct final_empty final
+    {
+        constexpr auto operator()(int value) const
+            -> int
+        {
+            return value + 1;
+        }
+    };
+
+    struct other_final_empty final {};
+}
+
+TEST_CASE( "test the size of pairs of non-final empty types" )
+{
+    // Those are handled by EBCO regardless of the standard revision
+    CHECK( sizeof(cruft::tight_pair<empty, int*>) == sizeof(int*) );
+    CHECK( sizeof(cruft::tight_pair<int*, empty>) == sizeof(int*) );
+    CHECK( sizeof(cruft::tight_pair<empty, other_empty>) == 1 );
+
+    // Two subobjects of the same type can't share an address
+    CHECK( sizeof(cruft::tight_pair<empty, empty>) == 2 );
+}
+
+TEST_CASE( "test the size of pairs of final empty types" )
+{
+#if CRUFT_TIGHT_PAIR_USE_NO_UNIQUE_ADDRESS
+    CHECK( sizeof(cruft::tight_pair<final_empty, int*>) == sizeof(int*) );
+    CHECK( sizeof(cruft::tight_pair<int*, final_empty>) == sizeof(int*) );
+    CHECK( sizeof(cruft::tight_pair<final_empty, int>) == sizeof(int) );
+    CHECK( sizeof(cruft::tight_pair<final_empty, other_final_empty>) == 1 );
+    CHECK( sizeof(cruft::tight_pair<final_empty, empty>) == 1 );
+    CHECK( sizeof(cruft::tight_pair<empty, final_empty>) == 1 );
+#else
+    CHECK( sizeof(cruft::tight_pair<final_empty, int*>) == 2 * sizeof(int*) );
+    CHECK( sizeof(cruft::tight_pair<int*, final_empty>) == 2 * sizeof(int*) );
+#endif
+
+    // Two subobjects of the same type can't share an address
+    CHECK( sizeof(cruft::tight_pair<final_empty, final_empty>) == 2 );
+}
+
+TEST_CASE( "test element access with compressed final empty types" )
+{
+    using cruft::get;
+
+    constexpr cruft::tight_pair<final_empty, int> p1(final_empty{}, 41);
+    static_assert(get<0>(p1)(get<1>(p1)) == 42);
+    CHECK( get<0>(p1)(get<1>(p1)) == 42 );
+
+    int value = 5;
+    cruft::tight_pair<int*, final_empty> p2(&value, final_empty{});
+    auto [ptr, func] = p2;
+    CHECK( ptr == &value );
+    CHECK( func(*ptr) == 6 );
+
+    cruft::tight_pair<int*, final_empty> p3(nullptr, final_empty{});
+    p3 = p2;
+    CHECK( get<0>(p3) == &value );
+    swap(p2, p3);
+    CHECK( get<0>(p2) == &value );
+}
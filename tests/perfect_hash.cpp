@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <array>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/perfect_hash.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+    using entry_t = cruft::tight_pair<pair_t, int>;
+
+    constexpr auto opcodes = cruft::make_constexpr_pair_map(std::array<entry_t, 6>{{
+        { pair_t(1, 0), 10 },
+        { pair_t(1, 1), 11 },
+        { pair_t(2, 0), 20 },
+        { pair_t(3, 7), 37 },
+        { pair_t(0, 0), 0 },
+        { pair_t(65535, 65535), -1 }
+    }});
+}
+
+TEST_CASE( "test constexpr_pair_map lookups at compile time" )
+{
+    static_assert(opcodes.size() == 6);
+    static_assert(opcodes.at(pair_t(1, 1)) == 11);
+    static_assert(opcodes.at(pair_t(3, 7)) == 37);
+    static_assert(opcodes.at(pair_t(0, 0)) == 0);
+    static_assert(opcodes.at(pair_t(65535, 65535)) == -1);
+    static_assert(not opcodes.contains(pair_t(0, 1)));
+    static_assert(not opcodes.contains(pair_t(7, 3)));
+    static_assert(opcodes.find(pair_t(2, 1)) == nullptr);
+
+    CHECK( opcodes.find(pair_t(2, 0))->get<1>() == 20 );
+    CHECK_THROWS_AS( opcodes.at(pair_t(4, 4)), std::out_of_range );
+
+    constexpr auto empty = cruft::make_constexpr_pair_map(std::array<entry_t, 0>{});
+    static_assert(empty.empty());
+    static_assert(not empty.contains(pair_t(0, 0)));
+
+    constexpr auto single = cruft::make_constexpr_pair_map(std::array<entry_t, 1>{{ { pair_t(4, 2), 42 } }});
+    static_assert(single.at(pair_t(4, 2)) == 42);
+    static_assert(not single.contains(pair_t(2, 4)));
+}
+
+TEST_CASE( "test constexpr_pair_map with random keys" )
+{
+    using big_pair = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    using big_entry = cruft::tight_pair<big_pair, std::uint32_t>;
+
+    std::mt19937 engine(0x5eed);
+    std::uniform_int_distribution<std::uint32_t> dist(0, 300);
+
+    std::set<std::pair<std::uint32_t, std::uint32_t>> seen;
+    std::array<big_entry, 500> entries;
+    for (std::size_t i = 0 ; i < entries.size() ; ++i) {
+        std::uint32_t first, second;
+        do {
+            first = dist(engine);
+            second = dist(engine);
+        } while (not seen.emplace(first, second).second);
+        entries[i] = big_entry(big_pair(first, second), static_cast<std::uint32_t>(i));
+    }
+
+    cruft::constexpr_pair_map<big_pair, std::uint32_t, 500> map(entries);
+    for (std::size_t i = 0 ; i < entries.size() ; ++i) {
+        CHECK( map.at(entries[i].get<0>()) == i );
+    }
+    for (std::uint32_t first = 0 ; first < 310 ; first += 3) {
+        for (std::uint32_t second = 0 ; second < 310 ; second += 7) {
+            CHECK( map.contains(big_pair(first, second)) == (seen.count({ first, second }) == 1) );
+        }
+    }
+}
+
+TEST_CASE( "test constexpr_pair_map rejects duplicate keys" )
+{
+    std::array<entry_t, 3> entries = {{
+        { pair_t(1, 2), 0 }, { pair_t(2, 1), 1 }, { pair_t(1, 2), 2 }
+    }};
+    CHECK_THROWS_AS( (cruft::constexpr_pair_map<pair_t, int, 3>(entries)), std::invalid_argument );
+}
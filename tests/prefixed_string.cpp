@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/prefixed_string.h>
+
+namespace
+{
+    auto sign(int value)
+        -> int
+    {
+        return (value > 0) - (value < 0);
+    }
+}
+
+TEST_CASE( "test prefixed_string_view prefix" )
+{
+    static_assert(cruft::prefixed_string_view("").prefix() == 0);
+    static_assert(cruft::prefixed_string_view("a").prefix() == 0x6100000000000000u);
+    static_assert(cruft::prefixed_string_view("abcdefgh").prefix() == 0x6162636465666768u);
+    static_assert(cruft::prefixed_string_view("abcdefghij").prefix() == 0x6162636465666768u);
+    static_assert(cruft::prefixed_string_view("abc") < cruft::prefixed_string_view("abd"));
+
+    cruft::prefixed_string_view str("\xff\x80");
+    CHECK( str.prefix() == 0xff80000000000000u );
+    CHECK( str.size() == 2 );
+    CHECK( str.view() == "\xff\x80" );
+}
+
+TEST_CASE( "test prefixed_string_view comparisons on ties" )
+{
+    using namespace std::string_view_literals;
+    using cruft::prefixed_string_view;
+
+    // Equal prefixes, differences after the first 8 bytes
+    CHECK( prefixed_string_view("abcdefgh1") < prefixed_string_view("abcdefgh2") );
+    CHECK( prefixed_string_view("abcdefgh") < prefixed_string_view("abcdefgh0") );
+    CHECK( prefixed_string_view("abcdefgh0") == prefixed_string_view("abcdefgh0") );
+
+    // Equal prefixes because of the zero padding
+    auto with_zero = prefixed_string_view("ab\0"sv);
+    CHECK( with_zero.prefix() == prefixed_string_view("ab").prefix() );
+    CHECK( prefixed_string_view("ab") < with_zero );
+    CHECK( prefixed_string_view("ab") != with_zero );
+    CHECK( with_zero > prefixed_string_view("ab") );
+}
+
+TEST_CASE( "test prefixed_string_view order matches std::string_view" )
+{
+    std::mt19937_64 engine(0x5eed);
+    std::uniform_int_distribution<int> length_dist(0, 12);
+    std::uniform_int_distribution<int> char_dist(0, 3);
+
+    // Small alphabet and lengths around 8 to get many ties
+    const char alphabet[] = { '\0', 'a', 'b', '\xff' };
+    std::vector<std::string> strings;
+    for (int i = 0 ; i < 300 ; ++i) {
+        std::string str;
+        for (int len = length_dist(engine) ; len > 0 ; --len) {
+            str.push_back(alphabet[char_dist(engine)]);
+        }
+        strings.push_back(str);
+    }
+
+    for (auto const& lhs: strings) {
+        for (auto const& rhs: strings) {
+            cruft::prefixed_string_view plhs(lhs);
+            cruft::prefixed_string_view prhs(rhs);
+            std::string_view vlhs(lhs);
+            std::string_view vrhs(rhs);
+            REQUIRE( sign(plhs.compare(prhs)) == sign(vlhs.compare(vrhs)) );
+            REQUIRE( (plhs < prhs) == (vlhs < vrhs) );
+            REQUIRE( (plhs == prhs) == (vlhs == vrhs) );
+        }
+    }
+}
+
+TEST_CASE( "test sorting pairs of prefixed strings" )
+{
+    using cruft::get;
+
+    std::vector<std::string> storage = {
+        "zebra", "apple", "applesauce", "applesauce", "application", "", "b", "apple"
+    };
+    std::vector<cruft::tight_pair<std::string_view, std::uint32_t>> pairs;
+    for (std::size_t i = 0 ; i < storage.size() ; ++i) {
+        pairs.emplace_back(storage[i], static_cast<std::uint32_t>(storage.size() - i));
+    }
+
+    std::vector<cruft::tight_pair<cruft::prefixed_string_view, std::uint32_t>> prefixed(pairs.size());
+    cruft::prefix_first(pairs.begin(), pairs.end(), prefixed.begin());
+    std::sort(prefixed.begin(), prefixed.end());
+    std::sort(pairs.begin(), pairs.end());
+
+    std::vector<cruft::tight_pair<std::string_view, std::uint32_t>> result(pairs.size());
+    cruft::unprefix_first(prefixed.begin(), prefixed.end(), result.begin());
+    CHECK( result == pairs );
+    CHECK( get<0>(result[0]) == "" );
+    CHECK( get<0>(result[1]) == "apple" );
+    CHECK( get<1>(result[1]) < get<1>(result[2]) );
+}
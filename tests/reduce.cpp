@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/reduce.h>
+
+namespace
+{
+    auto same_pair = [](auto const& lhs, auto const& rhs) {
+        return cruft::get<0>(lhs) == rhs.first && cruft::get<1>(lhs) == rhs.second;
+    };
+
+    // Sorted pairs with runs of random lengths, some of them longer
+    // than the blocks reduced at once
+    template<typename Value>
+    auto make_runs(std::mt19937_64& engine)
+        -> std::vector<cruft::tight_pair<std::uint32_t, Value>>
+    {
+        std::vector<cruft::tight_pair<std::uint32_t, Value>> res;
+        for (std::uint32_t key = 0 ; key < 100 ; ++key) {
+            auto length = engine() % 4 == 0 ? engine() % 500 : engine() % 5;
+            for (std::size_t i = 0 ; i < length ; ++i) {
+                res.emplace_back(key, Value(engine() % 100));
+            }
+        }
+        return res;
+    }
+}
+
+TEST_CASE( "test reduce_by_first" )
+{
+    std::mt19937_64 engine(0x5eed);
+
+    SECTION( "unsigned sums" )
+    {
+        auto pairs = make_runs<std::uint32_t>(engine);
+        std::map<std::uint32_t, std::uint32_t> expected;
+        for (auto const& pair: pairs) {
+            expected[cruft::get<0>(pair)] += cruft::get<1>(pair);
+        }
+
+        std::vector<cruft::tight_pair<std::uint32_t, std::uint32_t>> res;
+        cruft::reduce_by_first(pairs.begin(), pairs.end(), std::back_inserter(res));
+        REQUIRE( res.size() == expected.size() );
+        CHECK( std::equal(res.begin(), res.end(), expected.begin(), same_pair) );
+    }
+
+    SECTION( "floating point sums" )
+    {
+        // Small integral values are summed exactly in any order
+        auto pairs = make_runs<float>(engine);
+        std::map<std::uint32_t, float> expected;
+        for (auto const& pair: pairs) {
+            expected[cruft::get<0>(pair)] += cruft::get<1>(pair);
+        }
+
+        std::vector<cruft::tight_pair<std::uint32_t, float>> res;
+        cruft::reduce_by_first(pairs.begin(), pairs.end(), std::back_inserter(res));
+        REQUIRE( res.size() == expected.size() );
+        CHECK( std::equal(res.begin(), res.end(), expected.begin(), same_pair) );
+    }
+
+    SECTION( "minimum with forward iterators" )
+    {
+        auto pairs = make_runs<std::uint32_t>(engine);
+        std::list<std::pair<std::uint32_t, std::uint32_t>> input;
+        for (auto const& pair: pairs) {
+            input.emplace_back(cruft::get<0>(pair), cruft::get<1>(pair));
+        }
+        std::map<std::uint32_t, std::uint32_t> expected;
+        for (auto const& pair: pairs) {
+            auto it = expected.emplace(cruft::get<0>(pair), cruft::get<1>(pair)).first;
+            it->second = std::min(it->second, cruft::get<1>(pair));
+        }
+
+        std::vector<cruft::tight_pair<std::uint32_t, std::uint32_t>> res;
+        auto min = [](std::uint32_t lhs, std::uint32_t rhs) { return std::min(lhs, rhs); };
+        cruft::reduce_by_first(input.begin(), input.end(), std::back_inserter(res), min);
+        REQUIRE( res.size() == expected.size() );
+        CHECK( std::equal(res.begin(), res.end(), expected.begin(), same_pair) );
+    }
+}
+
+TEST_CASE( "test run_lengths_by_first" )
+{
+    std::mt19937_64 engine(0x5eed);
+    auto pairs = make_runs<std::uint32_t>(engine);
+    std::map<std::uint32_t, std::size_t> expected;
+    for (auto const& pair: pairs) {
+        ++expected[cruft::get<0>(pair)];
+    }
+
+    std::vector<cruft::tight_pair<std::uint32_t, std::size_t>> res;
+    cruft::run_lengths_by_first(pairs.begin(), pairs.end(), std::back_inserter(res));
+    REQUIRE( res.size() == expected.size() );
+    CHECK( std::equal(res.begin(), res.end(), expected.begin(), same_pair) );
+
+    res.clear();
+    cruft::run_lengths_by_first(pairs.begin(), pairs.begin(), std::back_inserter(res));
+    CHECK( res.empty() );
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/ring.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    auto same_pairs(std::vector<pair_t> const& lhs, std::vector<pair_t> const& rhs)
+        -> bool
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](pair_t const& x, pair_t const& y) { return x == y; });
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG( "test pair_ring in a single thread", "",
+                        ((cruft::ring_kind Kind), Kind),
+                        cruft::ring_kind::spsc, cruft::ring_kind::mpmc )
+{
+    cruft::pair_ring<std::uint32_t, std::uint32_t, Kind> ring(6);
+    CHECK( ring.capacity() == 8 );
+    CHECK( ring.empty() );
+
+    pair_t value;
+    CHECK_FALSE( ring.try_pop(value) );
+
+    // Fill the ring, then go around it several times
+    std::uint32_t pushed = 0, popped = 0;
+    for (; pushed < 8 ; ++pushed) {
+        CHECK( ring.try_push(pair_t(pushed, 2 * pushed)) );
+    }
+    CHECK_FALSE( ring.try_push(pair_t(0, 0)) );
+    CHECK( ring.size() == 8 );
+
+    for (int i = 0 ; i < 20 ; ++i) {
+        REQUIRE( ring.try_pop(value) );
+        CHECK( value == pair_t(popped, 2 * popped) );
+        ++popped;
+        CHECK( ring.try_push(pair_t(pushed, 2 * pushed)) );
+        ++pushed;
+    }
+
+    SECTION( "batched operations" )
+    {
+        std::vector<pair_t> out(16);
+        CHECK( ring.pop_n(out.begin(), 3) == 3 );
+        CHECK( out[0] == pair_t(popped, 2 * popped) );
+        CHECK( out[2] == pair_t(popped + 2, 2 * popped + 4) );
+        popped += 3;
+
+        // Only 3 free slots left
+        std::vector<pair_t> in = { {100, 1}, {101, 2}, {102, 3}, {103, 4} };
+        CHECK( ring.push_n(in.begin(), in.size()) == 3 );
+        CHECK( ring.push_n(in.begin(), 1) == 0 );
+
+        // Everything left comes out in order
+        CHECK( ring.pop_n(out.begin(), out.size()) == 8 );
+        CHECK( out[4] == pair_t(popped + 4, 2 * popped + 8) );
+        CHECK( out[5] == pair_t(100, 1) );
+        CHECK( out[7] == pair_t(102, 3) );
+        CHECK( ring.empty() );
+        CHECK( ring.pop_n(out.begin(), out.size()) == 0 );
+    }
+}
+
+TEST_CASE( "test pair_ring capacity" )
+{
+    using ring_t = cruft::pair_ring<std::uint32_t, std::uint32_t>;
+    constexpr auto max = std::numeric_limits<std::size_t>::max();
+
+    CHECK( ring_t(0).capacity() == 2 );
+    CHECK( ring_t(16).capacity() == 16 );
+    CHECK( ring_t(17).capacity() == 32 );
+
+    // No power of two is big enough
+    CHECK_THROWS_AS( ring_t(max / 2 + 2), std::length_error );
+    CHECK_THROWS_AS( ring_t(max), std::length_error );
+}
+
+TEST_CASE( "test pair_ring with one producer and one consumer" )
+{
+    constexpr std::uint32_t nb_values = 200'000;
+    cruft::pair_ring<std::uint32_t, std::uint32_t, cruft::ring_kind::spsc> ring(64);
+
+    std::thread producer([&] {
+        std::vector<pair_t> batch;
+        for (std::uint32_t i = 0 ; i < nb_values ; i += 7) {
+            batch.clear();
+            for (std::uint32_t j = i ; j < std::min(i + 7, nb_values) ; ++j) {
+                batch.emplace_back(j, ~j);
+            }
+            auto first = batch.begin();
+            while (first != batch.end()) {
+                auto count = ring.push_n(first, batch.end() - first);
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+                first += count;
+            }
+        }
+    });
+
+    std::vector<pair_t> received;
+    received.reserve(nb_values);
+    pair_t buffer[5];
+    while (received.size() < nb_values) {
+        auto count = ring.pop_n(buffer, 5);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        received.insert(received.end(), buffer, buffer + count);
+    }
+    producer.join();
+
+    std::vector<pair_t> expected;
+    for (std::uint32_t i = 0 ; i < nb_values ; ++i) {
+        expected.emplace_back(i, ~i);
+    }
+    CHECK( same_pairs(received, expected) );
+    CHECK( ring.empty() );
+}
+
+TEST_CASE( "test pair_ring with several producers and consumers" )
+{
+    constexpr std::uint32_t nb_values = 50'000;
+    constexpr std::uint32_t nb_threads = 3;
+    cruft::pair_ring<std::uint32_t, std::uint32_t, cruft::ring_kind::mpmc> ring(16);
+
+    // Every producer pushes its own values in order, alternating
+    // single and batched pushes
+    std::vector<std::thread> threads;
+    for (std::uint32_t p = 0 ; p < nb_threads ; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (std::uint32_t i = 0 ; i < nb_values ; i += 2) {
+                pair_t values[] = { {p, i}, {p, i + 1} };
+                if (i % 4 == 0) {
+                    for (auto const& value: values) {
+                        while (not ring.try_push(value)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                } else {
+                    std::size_t done = 0;
+                    while (done < 2) {
+                        auto count = ring.push_n(values + done, 2 - done);
+                        if (count == 0) {
+                            std::this_thread::yield();
+                        }
+                        done += count;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<pair_t>> received(nb_threads);
+    for (std::uint32_t c = 0 ; c < nb_threads ; ++c) {
+        threads.emplace_back([&ring, &received, c] {
+            pair_t buffer[3];
+            while (received[c].size() < nb_values) {
+                auto count = ring.pop_n(buffer, std::min<std::size_t>(3, nb_values - received[c].size()));
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+                received[c].insert(received[c].end(), buffer, buffer + count);
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    // Every value was received exactly once
+    std::vector<pair_t> all;
+    for (auto const& values: received) {
+        all.insert(all.end(), values.begin(), values.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<pair_t> expected;
+    for (std::uint32_t p = 0 ; p < nb_threads ; ++p) {
+        for (std::uint32_t i = 0 ; i < nb_values ; ++i) {
+            expected.emplace_back(p, i);
+        }
+    }
+    CHECK( same_pairs(all, expected) );
+    CHECK( ring.empty() );
+}
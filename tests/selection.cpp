@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/selection.h>
+
+namespace
+{
+    using string_pair_t = cruft::tight_pair<int, std::string>;
+
+    // Input iterator returning its elements by value, as proxy or
+    // transform iterators do
+    struct generating_iterator
+    {
+        using iterator_category = std::input_iterator_tag;
+        using value_type = string_pair_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = string_pair_t;
+
+        int index;
+
+        auto operator*() const
+            -> string_pair_t
+        {
+            // Long enough strings to not fit in the small string buffer
+            return { (index * 7) % 10, std::string(32, char('a' + index)) };
+        }
+
+        auto operator++()
+            -> generating_iterator&
+        {
+            ++index;
+            return *this;
+        }
+
+        friend auto operator!=(generating_iterator lhs, generating_iterator rhs)
+            -> bool
+        {
+            return lhs.index != rhs.index;
+        }
+
+        friend auto operator==(generating_iterator lhs, generating_iterator rhs)
+            -> bool
+        {
+            return lhs.index == rhs.index;
+        }
+    };
+}
+
+TEST_CASE( "test min and max element of packed pairs" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    std::mt19937_64 engine(0x5eed);
+
+    for (std::size_t size: { 0, 1, 63, 64, 65, 1000 }) {
+        // Few distinct values to check that ties are handled like
+        // in the standard library
+        for (std::uint32_t max: { 2u, 100u }) {
+            std::vector<pair_t> pairs;
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                pairs.emplace_back(std::uint32_t(engine() % max), std::uint32_t(engine() % 2));
+            }
+
+            CHECK( cruft::min_element_packed(pairs.begin(), pairs.end())
+                   == std::min_element(pairs.begin(), pairs.end()) );
+            CHECK( cruft::max_element_packed(pairs.begin(), pairs.end())
+                   == std::max_element(pairs.begin(), pairs.end()) );
+            CHECK( cruft::minmax_element_packed(pairs.begin(), pairs.end())
+                   == std::minmax_element(pairs.begin(), pairs.end()) );
+        }
+    }
+}
+
+TEST_CASE( "test top_k" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    std::mt19937_64 engine(0x5eed);
+
+    std::vector<pair_t> pairs;
+    for (std::size_t i = 0 ; i < 5000 ; ++i) {
+        pairs.emplace_back(std::uint32_t(engine() % 1000), std::uint32_t(i));
+    }
+
+    for (std::size_t k: { 0, 1, 10, 300, 5000, 6000 }) {
+        auto expected = pairs;
+        auto middle = expected.begin() + std::min(k, expected.size());
+        std::partial_sort(expected.begin(), middle, expected.end());
+        expected.erase(middle, expected.end());
+
+        std::vector<pair_t> res;
+        cruft::top_k(pairs.begin(), pairs.end(), k, std::back_inserter(res));
+        CHECK( res == expected );
+
+        expected = pairs;
+        middle = expected.begin() + std::min(k, expected.size());
+        std::partial_sort(expected.begin(), middle, expected.end(), std::greater<>{});
+        expected.erase(middle, expected.end());
+
+        res.clear();
+        cruft::top_k(pairs.begin(), pairs.end(), k, std::back_inserter(res), std::greater<>{});
+        CHECK( res == expected );
+    }
+}
+
+TEST_CASE( "test top_k fallback" )
+{
+    using pair_t = cruft::tight_pair<int, std::string>;
+
+    std::list<pair_t> pairs = {
+        {5, "e"}, {1, "a"}, {4, "d"}, {2, "b"}, {3, "c"}, {0, "z"}
+    };
+    std::vector<pair_t> res;
+    cruft::top_k(pairs.begin(), pairs.end(), 3, std::back_inserter(res));
+    CHECK( res == std::vector<pair_t>{ {0, "z"}, {1, "a"}, {2, "b"} } );
+
+    CHECK( cruft::get<1>(*cruft::min_element_packed(pairs.begin(), pairs.end())) == "z" );
+}
+
+TEST_CASE( "test top_k fallback with an iterator returning prvalues" )
+{
+    std::vector<string_pair_t> res;
+    cruft::top_k(generating_iterator{0}, generating_iterator{10}, 3, std::back_inserter(res));
+    CHECK( res == std::vector<string_pair_t>{
+        { 0, std::string(32, 'a') }, { 1, std::string(32, 'd') }, { 2, std::string(32, 'g') }
+    } );
+}
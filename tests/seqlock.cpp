@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/seqlock.h>
+
+namespace
+{
+    struct empty_member {};
+
+    struct big_member
+    {
+        std::uint64_t values[5];
+    };
+}
+
+TEST_CASE( "test seqlock_tight_pair loads and stores" )
+{
+    using cruft::get;
+
+    cruft::seqlock_tight_pair<double, std::uint64_t> pair(1.5, 3);
+    auto value = pair.load();
+    CHECK( get<0>(value) == 1.5 );
+    CHECK( get<1>(value) == 3 );
+
+    pair.store(cruft::tight_pair<double, std::uint64_t>(-2.25, 42));
+    value = pair.load();
+    CHECK( get<0>(value) == -2.25 );
+    CHECK( get<1>(value) == 42 );
+
+    cruft::seqlock_tight_pair<char, std::uint16_t> small;
+    CHECK( get<0>(small.load()) == 0 );
+    CHECK( get<1>(small.load()) == 0 );
+    small.store('a', 5);
+    CHECK( get<0>(small.load()) == 'a' );
+    CHECK( get<1>(small.load()) == 5 );
+}
+
+TEST_CASE( "test seqlock_tight_pair with empty members" )
+{
+    using cruft::get;
+
+    // Empty members take no space
+    CHECK( sizeof(cruft::seqlock_tight_pair<empty_member, std::uint64_t>) ==
+           sizeof(cruft::seqlock_tight_pair<std::uint64_t, std::uint64_t>) - sizeof(std::uintptr_t) );
+
+    cruft::seqlock_tight_pair<empty_member, std::uint32_t> pair;
+    pair.store(empty_member{}, 8u);
+    CHECK( get<1>(pair.load()) == 8u );
+}
+
+TEST_CASE( "test seqlock_tight_pair consistency with concurrent writers" )
+{
+    using cruft::get;
+    using pair_t = cruft::tight_pair<big_member, std::uint64_t>;
+
+    // Every write stores the same value in every word of both
+    // members, a torn read would return different values
+    cruft::seqlock_tight_pair<big_member, std::uint64_t> pair;
+    std::atomic<bool> done(false);
+    std::atomic<int> nb_torn(0);
+
+    std::vector<std::thread> threads;
+    for (std::uint64_t w = 0 ; w < 2 ; ++w) {
+        threads.emplace_back([&, w] {
+            for (std::uint64_t i = 1 ; i <= 20'000 ; ++i) {
+                auto value = 2 * i + w;
+                pair.store(pair_t(big_member{{ value, value, value, value, value }}, value));
+            }
+        });
+    }
+    std::vector<std::thread> readers;
+    for (int r = 0 ; r < 2 ; ++r) {
+        readers.emplace_back([&] {
+            while (not done.load()) {
+                auto value = pair.load();
+                auto const& member = get<0>(value);
+                for (auto word: member.values) {
+                    if (word != get<1>(value)) {
+                        ++nb_torn;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    done = true;
+    for (auto& thread: readers) {
+        thread.join();
+    }
+
+    CHECK( nb_torn == 0 );
+    auto last = get<1>(pair.load());
+    CHECK( (last == 40'000 || last == 40'001) );
+}
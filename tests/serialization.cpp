@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/mapped_pair_table.h>
+#include <tight_pair/serialization.h>
+
+namespace
+{
+    template<typename T1, typename T2>
+    auto make_sorted_pairs(std::size_t size)
+        -> std::vector<cruft::tight_pair<T1, T2>>
+    {
+        std::mt19937_64 engine(0x5eed);
+        std::vector<cruft::tight_pair<T1, T2>> pairs;
+        for (std::size_t i = 0 ; i < size ; ++i) {
+            pairs.emplace_back(T1(engine() % 64), T2(engine()));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    template<typename T1, typename T2>
+    auto check_view(cruft::pair_table_view<T1, T2> view,
+                    std::vector<cruft::tight_pair<T1, T2>> const& pairs)
+        -> void
+    {
+        REQUIRE( view.size() == pairs.size() );
+        for (std::size_t i = 0 ; i < pairs.size() ; ++i) {
+            CHECK( view[i] == pairs[i] );
+        }
+
+        for (auto const& pair: pairs) {
+            auto pos = view.find(pair);
+            REQUIRE( pos != view.size() );
+            CHECK( view[pos] == pair );
+
+            auto lower = std::lower_bound(pairs.begin(), pairs.end(), pair);
+            auto upper = std::upper_bound(pairs.begin(), pairs.end(), pair);
+            CHECK( view.lower_bound(pair) == std::size_t(lower - pairs.begin()) );
+            CHECK( view.upper_bound(pair) == std::size_t(upper - pairs.begin()) );
+        }
+
+        cruft::tight_pair<T1, T2> missing(T1(100), T2(0));
+        CHECK( view.find(missing) == view.size() );
+        CHECK( not view.contains(missing) );
+    }
+}
+
+TEST_CASE( "test canonical pair encoding" )
+{
+    unsigned char buffer[6] = {};
+    auto end = cruft::encode_pair(cruft::tight_pair<std::uint16_t, std::uint32_t>(0x0102, 0x03040506), buffer);
+    CHECK( end == buffer + 6 );
+    unsigned char expected[6] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    CHECK( std::memcmp(buffer, expected, 6) == 0 );
+
+    auto pair = cruft::decode_pair<std::uint16_t, std::uint32_t>(buffer);
+    CHECK( pair == cruft::tight_pair<std::uint16_t, std::uint32_t>(0x0102, 0x03040506) );
+}
+
+TEST_CASE( "test that encoded pairs are ordered like pairs" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    std::mt19937_64 engine(0x5eed);
+    for (int i = 0 ; i < 1000 ; ++i) {
+        pair_t lhs(std::uint32_t(engine() % 4), std::uint32_t(engine()));
+        pair_t rhs(std::uint32_t(engine() % 4), std::uint32_t(engine()));
+
+        unsigned char lhs_bytes[8];
+        unsigned char rhs_bytes[8];
+        cruft::encode_pair(lhs, lhs_bytes);
+        cruft::encode_pair(rhs, rhs_bytes);
+
+        int res = std::memcmp(lhs_bytes, rhs_bytes, 8);
+        CHECK( (res < 0) == (lhs < rhs) );
+        CHECK( (res == 0) == (lhs == rhs) );
+    }
+}
+
+TEST_CASE( "test pair table view" )
+{
+    SECTION( "same types" )
+    {
+        auto pairs = make_sorted_pairs<std::uint32_t, std::uint32_t>(500);
+        std::ostringstream stream;
+        cruft::write_pair_table(stream, pairs.begin(), pairs.end());
+        auto bytes = stream.str();
+        CHECK( bytes.size() == pairs.size() * 8 );
+
+        cruft::pair_table_view<std::uint32_t, std::uint32_t> view(
+            reinterpret_cast<unsigned char const*>(bytes.data()), bytes.size()
+        );
+        check_view(view, pairs);
+    }
+
+    SECTION( "different types" )
+    {
+        auto pairs = make_sorted_pairs<std::uint8_t, std::uint64_t>(500);
+        std::ostringstream stream;
+        cruft::write_pair_table(stream, pairs.begin(), pairs.end());
+        auto bytes = stream.str();
+        CHECK( bytes.size() == pairs.size() * 9 );
+
+        cruft::pair_table_view<std::uint8_t, std::uint64_t> view(
+            reinterpret_cast<unsigned char const*>(bytes.data()), bytes.size()
+        );
+        check_view(view, pairs);
+    }
+
+    SECTION( "empty view" )
+    {
+        cruft::pair_table_view<std::uint16_t, std::uint16_t> view;
+        CHECK( view.empty() );
+        CHECK( view.lower_bound({1, 2}) == 0 );
+        CHECK( not view.contains({1, 2}) );
+    }
+}
+
+TEST_CASE( "test memory-mapped pair table" )
+{
+    const std::string path = "tight_pair-mapped-table-test.bin";
+    auto pairs = make_sorted_pairs<std::uint16_t, std::uint16_t>(5000);
+    {
+        std::ofstream file(path, std::ios::binary);
+        cruft::write_pair_table(file, pairs.begin(), pairs.end());
+    }
+
+    {
+        cruft::mapped_pair_table<std::uint16_t, std::uint16_t> table(path);
+        check_view(table.view(), pairs);
+
+        auto moved = std::move(table);
+        CHECK( table.empty() );
+        CHECK( moved.size() == pairs.size() );
+        CHECK( moved.contains(pairs[42]) );
+    }
+
+    CHECK_THROWS_AS( (cruft::mapped_pair_table<std::uint32_t, std::uint64_t>(path)), std::runtime_error );
+    std::remove(path.c_str());
+
+    CHECK_THROWS_AS( (cruft::mapped_pair_table<std::uint32_t, std::uint32_t>(path)), std::system_error );
+}
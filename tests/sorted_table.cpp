@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/sorted_table.h>
+
+namespace
+{
+    using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+
+    constexpr auto table = cruft::make_sorted_table(std::array<pair_t, 7>{{
+        { 5, 1 }, { 2, 9 }, { 5, 0 }, { 0, 3 }, { 9, 9 }, { 2, 1 }, { 7, 4 }
+    }});
+
+    struct compare_first
+    {
+        constexpr auto operator()(cruft::tight_pair<int, int> const& lhs,
+                                  cruft::tight_pair<int, int> const& rhs) const
+            -> bool
+        {
+            return cruft::get<0>(lhs) < cruft::get<0>(rhs);
+        }
+    };
+}
+
+TEST_CASE( "test sorted_table built at compile time" )
+{
+    static_assert(table[0] == pair_t(0, 3));
+    static_assert(table[1] == pair_t(2, 1));
+    static_assert(table[6] == pair_t(9, 9));
+    static_assert(table.contains(pair_t(5, 0)));
+    static_assert(not table.contains(pair_t(5, 2)));
+    static_assert(table.lower_bound(pair_t(5, 2)) == table.begin() + 5);
+    static_assert(table.upper_bound(pair_t(2, 1)) == table.begin() + 2);
+    static_assert(table.find(pair_t(10, 0)) == table.end());
+    static_assert(sizeof(table) == 7 * sizeof(pair_t));
+
+    CHECK( std::is_sorted(table.begin(), table.end()) );
+    CHECK( table.find(pair_t(7, 4)) == table.begin() + 5 );
+
+    constexpr auto empty = cruft::make_sorted_table(std::array<pair_t, 0>{});
+    static_assert(empty.empty());
+    static_assert(not empty.contains(pair_t(0, 0)));
+}
+
+TEST_CASE( "test sorted_table with custom comparisons" )
+{
+    using cruft::get;
+    using int_pair = cruft::tight_pair<int, int>;
+
+    constexpr auto reversed = cruft::make_sorted_table(std::array<pair_t, 4>{{
+        { 1, 1 }, { 3, 0 }, { 0, 2 }, { 3, 1 }
+    }}, std::greater<>{});
+    static_assert(reversed[0] == pair_t(3, 1));
+    static_assert(reversed[3] == pair_t(0, 2));
+    static_assert(reversed.contains(pair_t(1, 1)));
+    static_assert(not reversed.contains(pair_t(2, 1)));
+
+    // The sort is stable, equivalent elements keep their order
+    constexpr auto by_first = cruft::make_sorted_table(std::array<int_pair, 5>{{
+        { 2, 0 }, { 1, 0 }, { 2, 1 }, { 1, 1 }, { 2, 2 }
+    }}, compare_first{});
+    static_assert(get<1>(by_first[0]) == 0 && get<1>(by_first[1]) == 1);
+    static_assert(get<1>(by_first[2]) == 0 && get<1>(by_first[4]) == 2);
+    static_assert(by_first.find(int_pair(2, 7)) == by_first.begin() + 2);
+    static_assert(by_first.upper_bound(int_pair(1, 7)) == by_first.begin() + 2);
+}
+
+TEST_CASE( "test sorted_table against std::sort" )
+{
+    std::mt19937_64 engine(0x5eed);
+    std::uniform_int_distribution<std::uint16_t> dist(0, 50);
+
+    std::array<pair_t, 1000> values;
+    for (auto& value: values) {
+        value = pair_t(dist(engine), dist(engine));
+    }
+    cruft::sorted_table<pair_t, 1000> sorted(values);
+    std::vector<pair_t> expected(values.begin(), values.end());
+    std::sort(expected.begin(), expected.end());
+    CHECK( std::equal(sorted.begin(), sorted.end(), expected.begin(), expected.end()) );
+
+    for (int i = 0 ; i < 1000 ; ++i) {
+        pair_t value(dist(engine), dist(engine));
+        CHECK( sorted.lower_bound(value) - sorted.begin() ==
+               std::lower_bound(expected.begin(), expected.end(), value) - expected.begin() );
+        CHECK( sorted.upper_bound(value) - sorted.begin() ==
+               std::upper_bound(expected.begin(), expected.end(), value) - expected.begin() );
+        CHECK( sorted.contains(value) == std::binary_search(expected.begin(), expected.end(), value) );
+    }
+}
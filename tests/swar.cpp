@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/swar.h>
+
+namespace
+{
+    template<typename T>
+    auto check_elementwise(T x1, T x2, T y1, T y2)
+        -> void
+    {
+        using cruft::get;
+        using pair_t = cruft::tight_pair<T, T>;
+        constexpr auto all_ones = std::numeric_limits<T>::max();
+
+        pair_t lhs(x1, x2);
+        pair_t rhs(y1, y2);
+
+        CHECK( cruft::swar::add(lhs, rhs) == pair_t(T(x1 + y1), T(x2 + y2)) );
+        CHECK( cruft::swar::sub(lhs, rhs) == pair_t(T(x1 - y1), T(x2 - y2)) );
+        CHECK( cruft::swar::min(lhs, rhs) == pair_t(std::min(x1, y1), std::min(x2, y2)) );
+        CHECK( cruft::swar::max(lhs, rhs) == pair_t(std::max(x1, y1), std::max(x2, y2)) );
+        CHECK( cruft::swar::add_sat(lhs, rhs) == pair_t(
+            T(x1 + y1) < x1 ? all_ones : T(x1 + y1),
+            T(x2 + y2) < x2 ? all_ones : T(x2 + y2)
+        ));
+        CHECK( cruft::swar::equal_mask(lhs, rhs) == pair_t(
+            x1 == y1 ? all_ones : T(0),
+            x2 == y2 ? all_ones : T(0)
+        ));
+        CHECK( cruft::swar::less_mask(lhs, rhs) == pair_t(
+            x1 < y1 ? all_ones : T(0),
+            x2 < y2 ? all_ones : T(0)
+        ));
+    }
+
+    template<typename T>
+    auto check_random_elementwise()
+        -> void
+    {
+        constexpr auto max = std::numeric_limits<T>::max();
+        std::mt19937_64 engine(0x5eed);
+        std::uniform_int_distribution<std::uint64_t> dist(0, max);
+
+        // Edge cases for carries and borrows
+        T values[] = { 0, 1, T(max / 2), T(max / 2 + 1), T(max - 1), max };
+        for (T x1: values) {
+            for (T x2: values) {
+                check_elementwise<T>(x1, x2, x2, x1);
+                check_elementwise<T>(x1, x2, x1, x2);
+                check_elementwise<T>(x1, x1, x2, x2);
+            }
+        }
+
+        for (int i = 0 ; i < 100 ; ++i) {
+            check_elementwise<T>(T(dist(engine)), T(dist(engine)),
+                                 T(dist(engine)), T(dist(engine)));
+        }
+    }
+}
+
+TEST_CASE( "test SWAR element-wise operations" )
+{
+    SECTION( "std::uint8_t" )
+    {
+        check_random_elementwise<std::uint8_t>();
+    }
+
+    SECTION( "std::uint16_t" )
+    {
+        check_random_elementwise<std::uint16_t>();
+    }
+
+    SECTION( "std::uint32_t" )
+    {
+        check_random_elementwise<std::uint32_t>();
+    }
+
+    SECTION( "std::uint64_t" )
+    {
+        check_random_elementwise<std::uint64_t>();
+    }
+}
+
+TEST_CASE( "test constexpr SWAR element-wise operations" )
+{
+    using pair_t = cruft::tight_pair<std::uint16_t, std::uint16_t>;
+
+    static_assert(cruft::swar::add(pair_t(0xffff, 1), pair_t(1, 2)) == pair_t(0, 3));
+    static_assert(cruft::swar::sub(pair_t(0, 3), pair_t(1, 2)) == pair_t(0xffff, 1));
+    static_assert(cruft::swar::add_sat(pair_t(0xffff, 1), pair_t(1, 2)) == pair_t(0xffff, 3));
+    static_assert(cruft::swar::min(pair_t(5, 8), pair_t(6, 7)) == pair_t(5, 7));
+    static_assert(cruft::swar::max(pair_t(5, 8), pair_t(6, 7)) == pair_t(6, 8));
+    static_assert(cruft::swar::less_mask(pair_t(5, 8), pair_t(6, 7)) == pair_t(0xffff, 0));
+    static_assert(cruft::swar::equal_mask(pair_t(5, 8), pair_t(5, 7)) == pair_t(0xffff, 0));
+}
+
+TEST_CASE( "test batch SWAR element-wise operations" )
+{
+    using cruft::get;
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+
+    std::vector<pair_t> counters;
+    std::vector<pair_t> deltas;
+    for (std::uint32_t i = 0 ; i < 100 ; ++i) {
+        counters.emplace_back(i, 0xffffffffu - i);
+        deltas.emplace_back(1u, i);
+    }
+
+    std::vector<pair_t> res(counters.size());
+    auto end = cruft::swar::add(counters.begin(), counters.end(), deltas.begin(), res.begin());
+    CHECK( end == res.end() );
+    for (std::uint32_t i = 0 ; i < 100 ; ++i) {
+        CHECK( res[i] == pair_t(i + 1, 0xffffffffu) );
+    }
+
+    cruft::swar::add_sat(res.begin(), res.end(), deltas.begin(), res.begin());
+    for (std::uint32_t i = 0 ; i < 100 ; ++i) {
+        CHECK( res[i] == pair_t(i + 2, 0xffffffffu) );
+    }
+
+    cruft::swar::min(counters.begin(), counters.end(), deltas.begin(), res.begin());
+    for (std::uint32_t i = 0 ; i < 100 ; ++i) {
+        CHECK( res[i] == pair_t(i == 0 ? 0 : 1, i) );
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+#include <tight_pair/unique.h>
+
+TEST_CASE( "test unique_packed" )
+{
+    using pair_t = cruft::tight_pair<std::uint32_t, std::uint32_t>;
+    std::mt19937_64 engine(0x5eed);
+
+    for (std::size_t size: { 0, 1, 2, 100, 5000 }) {
+        for (std::uint32_t max: { 1u, 3u, 1000u }) {
+            std::vector<pair_t> pairs;
+            for (std::size_t i = 0 ; i < size ; ++i) {
+                pairs.emplace_back(std::uint32_t(engine() % max), std::uint32_t(engine() % 2));
+            }
+            std::sort(pairs.begin(), pairs.end());
+
+            auto expected = pairs;
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+            auto res = cruft::unique_packed(pairs.begin(), pairs.end());
+            CHECK( res.duplicates == size - expected.size() );
+            CHECK( std::equal(pairs.begin(), res.last, expected.begin(), expected.end()) );
+        }
+    }
+}
+
+TEST_CASE( "test unique_packed fallback" )
+{
+    using pair_t = cruft::tight_pair<int, std::string>;
+
+    std::list<pair_t> pairs = {
+        {1, "a"}, {1, "a"}, {1, "b"}, {2, "b"}, {2, "b"}, {2, "b"}, {3, "c"}
+    };
+    auto res = cruft::unique_packed(pairs.begin(), pairs.end());
+    CHECK( res.duplicates == 3 );
+    pairs.erase(res.last, pairs.end());
+    CHECK( pairs == std::list<pair_t>{ {1, "a"}, {1, "b"}, {2, "b"}, {3, "c"} } );
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021 Morwenn
+ * SPDX-License-Identifier: MIT
+ */
+#include <cstddef>
+#include <memory>
+#include <scoped_allocator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <tight_pair.h>
+
+#if __has_include(<memory_resource>)
+#   include <memory_resource>
+#endif
+
+namespace
+{
+    // Long enough to not fit in the small string buffer
+    constexpr char const* long_string = "a string long enough to need an allocation";
+
+    // Stateful allocator identified by an integer, used to check
+    // that the allocator is passed down to the members
+    template<typename T>
+    struct tagged_allocator
+    {
+        using value_type = T;
+
+        int tag = 0;
+
+        tagged_allocator() = default;
+
+        explicit tagged_allocator(int tag) noexcept:
+            tag(tag)
+        {}
+
+        template<typename U>
+        tagged_allocator(tagged_allocator<U> const& other) noexcept:
+            tag(other.tag)
+        {}
+
+        auto allocate(std::size_t n)
+            -> T*
+        {
+            return std::allocator<T>().allocate(n);
+        }
+
+        auto deallocate(T* ptr, std::size_t n) noexcept
+            -> void
+        {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+
+        template<typename U>
+        friend auto operator==(tagged_allocator const& lhs, tagged_allocator<U> const& rhs) noexcept
+            -> bool
+        {
+            return lhs.tag == rhs.tag;
+        }
+
+        template<typename U>
+        friend auto operator!=(tagged_allocator const& lhs, tagged_allocator<U> const& rhs) noexcept
+            -> bool
+        {
+            return lhs.tag != rhs.tag;
+        }
+    };
+
+    // Allocator-aware type taking its allocator after std::allocator_arg,
+    // trivially destructible to keep the containers tests small
+    template<typename Alloc>
+    struct allocated_value
+    {
+        using allocator_type = Alloc;
+
+        allocator_type allocator;
+        int value = 0;
+
+        allocated_value() = default;
+        allocated_value(allocated_value const&) = default;
+
+        explicit allocated_value(int value) noexcept:
+            value(value)
+        {}
+
+        allocated_value(std::allocator_arg_t, allocator_type const& alloc) noexcept:
+            allocator(alloc)
+        {}
+
+        allocated_value(std::allocator_arg_t, allocator_type const& alloc, int value) noexcept:
+            allocator(alloc),
+            value(value)
+        {}
+
+        allocated_value(std::allocator_arg_t, allocator_type const& alloc, allocated_value const& other) noexcept:
+            allocator(alloc),
+            value(other.value)
+        {}
+    };
+
+    using tagged_string = std::basic_string<char, std::char_traits<char>, tagged_allocator<char>>;
+    using tagged_value = allocated_value<tagged_allocator<char>>;
+}
+
+TEST_CASE( "test uses_allocator trait for tight_pair" )
+{
+    using alloc_t = tagged_allocator<char>;
+    CHECK( std::uses_allocator_v<cruft::tight_pair<tagged_string, int>, alloc_t> );
+    CHECK( std::uses_allocator_v<cruft::tight_pair<int, int>, alloc_t> );
+
+    // The members have to be constructible from the elements of a pair-like argument
+    using pair_t = cruft::tight_pair<tagged_string, int>;
+    CHECK( std::is_constructible_v<pair_t, std::allocator_arg_t, alloc_t const&, std::pair<char const*, int>> );
+    CHECK_FALSE( std::is_constructible_v<pair_t, std::allocator_arg_t, alloc_t const&, std::pair<int*, int>> );
+    CHECK_FALSE( std::is_constructible_v<pair_t, std::allocator_arg_t, alloc_t const&, std::tuple<int, int>> );
+}
+
+TEST_CASE( "test tight_pair allocator-extended constructors" )
+{
+    using cruft::get;
+    using pair_t = cruft::tight_pair<tagged_string, int>;
+
+    tagged_allocator<char> alloc(42);
+
+    SECTION( "default construction" )
+    {
+        pair_t pair(std::allocator_arg, alloc);
+        CHECK( get<0>(pair).get_allocator().tag == 42 );
+        CHECK( get<1>(pair) == 0 );
+    }
+
+    SECTION( "construction from members" )
+    {
+        pair_t pair(std::allocator_arg, alloc, long_string, 5);
+        CHECK( get<0>(pair).get_allocator().tag == 42 );
+        CHECK( get<0>(pair) == long_string );
+        CHECK( get<1>(pair) == 5 );
+    }
+
+    SECTION( "copy and move construction" )
+    {
+        pair_t original(long_string, 5);
+        CHECK( get<0>(original).get_allocator().tag == 0 );
+
+        pair_t copy(std::allocator_arg, alloc, original);
+        CHECK( get<0>(copy).get_allocator().tag == 42 );
+        CHECK( get<0>(copy) == long_string );
+
+        pair_t moved(std::allocator_arg, alloc, std::move(copy));
+        CHECK( get<0>(moved).get_allocator().tag == 42 );
+        CHECK( get<0>(moved) == long_string );
+    }
+
+    SECTION( "construction from a pair-like type" )
+    {
+        pair_t pair(std::allocator_arg, alloc, std::make_pair(long_string, 8));
+        CHECK( get<0>(pair).get_allocator().tag == 42 );
+        CHECK( get<1>(pair) == 8 );
+    }
+
+    SECTION( "piecewise construction" )
+    {
+        pair_t pair(std::allocator_arg, alloc, std::piecewise_construct,
+                    std::forward_as_tuple(50, 'x'), std::forward_as_tuple(3));
+        CHECK( get<0>(pair).get_allocator().tag == 42 );
+        CHECK( get<0>(pair) == tagged_string(50, 'x') );
+        CHECK( get<1>(pair) == 3 );
+    }
+
+    SECTION( "leading allocator convention" )
+    {
+        cruft::tight_pair<tagged_value, tagged_value> pair(std::allocator_arg, alloc, 1, 2);
+        CHECK( get<0>(pair).allocator.tag == 42 );
+        CHECK( get<0>(pair).value == 1 );
+        CHECK( get<1>(pair).allocator.tag == 42 );
+        CHECK( get<1>(pair).value == 2 );
+    }
+
+    SECTION( "class template argument deduction" )
+    {
+        cruft::tight_pair pair(std::allocator_arg, alloc, tagged_string(long_string), 2);
+        CHECK( std::is_same_v<decltype(pair), pair_t> );
+        CHECK( get<0>(pair).get_allocator().tag == 42 );
+    }
+}
+
+TEST_CASE( "test tight_pair with scoped_allocator_adaptor" )
+{
+    using cruft::get;
+    using pair_t = cruft::tight_pair<tagged_value, tagged_value>;
+    using alloc_t = std::scoped_allocator_adaptor<tagged_allocator<pair_t>>;
+
+    std::vector<pair_t, alloc_t> vec(alloc_t(tagged_allocator<pair_t>(42)));
+    vec.emplace_back(1, 2);
+    vec.emplace_back(std::piecewise_construct, std::forward_as_tuple(3), std::forward_as_tuple());
+    vec.push_back(pair_t(tagged_value(4), tagged_value(5)));
+    vec.resize(5);
+
+    for (auto const& pair: vec) {
+        CHECK( get<0>(pair).allocator.tag == 42 );
+        CHECK( get<1>(pair).allocator.tag == 42 );
+    }
+    CHECK( get<0>(vec[1]).value == 3 );
+    CHECK( get<1>(vec[2]).value == 5 );
+
+    SECTION( "nested pairs" )
+    {
+        using nested_t = cruft::tight_pair<pair_t, tagged_value>;
+        using nested_alloc_t = std::scoped_allocator_adaptor<tagged_allocator<nested_t>>;
+        std::vector<nested_t, nested_alloc_t> nested(nested_alloc_t(tagged_allocator<nested_t>(7)));
+        nested.emplace_back(vec[0], 6);
+        CHECK( get<0>(get<0>(nested[0])).allocator.tag == 7 );
+        CHECK( get<0>(get<0>(nested[0])).value == 1 );
+        CHECK( get<1>(nested[0]).allocator.tag == 7 );
+    }
+
+    SECTION( "members that don't use allocators" )
+    {
+        using ints_t = cruft::tight_pair<int, long>;
+        using ints_alloc_t = std::scoped_allocator_adaptor<tagged_allocator<ints_t>>;
+        std::vector<ints_t, ints_alloc_t> ints(ints_alloc_t(tagged_allocator<ints_t>(7)));
+        ints.emplace_back(1, 2L);
+        ints.push_back(ints[0]);
+        ints.resize(4);
+        CHECK( get<1>(ints[1]) == 2L );
+    }
+}
+
+#if defined(__cpp_lib_memory_resource)
+TEST_CASE( "test tight_pair with polymorphic allocators" )
+{
+    using cruft::get;
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::polymorphic_allocator<char> alloc(&arena);
+
+    SECTION( "allocator-extended constructors" )
+    {
+        using pair_t = cruft::tight_pair<std::pmr::string, int>;
+
+        pair_t pair(std::allocator_arg, alloc, long_string, 5);
+        CHECK( get<0>(pair).get_allocator().resource() == &arena );
+
+        pair_t copy(std::allocator_arg, alloc, pair_t(long_string, 6));
+        CHECK( get<0>(copy).get_allocator().resource() == &arena );
+        CHECK( get<1>(copy) == 6 );
+    }
+
+    SECTION( "pmr containers" )
+    {
+        using value_t = allocated_value<std::pmr::polymorphic_allocator<char>>;
+        using pair_t = cruft::tight_pair<value_t, int>;
+
+        std::pmr::vector<pair_t> vec(&arena);
+        vec.emplace_back(value_t(1), 1);
+        vec.emplace_back(std::piecewise_construct, std::forward_as_tuple(2), std::forward_as_tuple(2));
+        vec.resize(5);
+
+        for (auto const& pair: vec) {
+            CHECK( get<0>(pair).allocator.resource() == &arena );
+        }
+        CHECK( get<0>(vec[1]).value == 2 );
+    }
+}
+#endif
+
+#if defined(__cpp_lib_make_obj_using_allocator)
+TEST_CASE( "test tight_pair with C++20 uses-allocator construction functions" )
+{
+    using cruft::get;
+    using pair_t = cruft::tight_pair<tagged_string, int>;
+
+    tagged_allocator<char> alloc(42);
+
+    auto pair = std::make_obj_using_allocator<pair_t>(alloc, long_string, 4);
+    CHECK( get<0>(pair).get_allocator().tag == 42 );
+    CHECK( get<1>(pair) == 4 );
+
+    // The arguments reference temporaries, consume them in the same expression
+    auto other = std::make_from_tuple<pair_t>(
+        std::uses_allocator_construction_args<pair_t>(alloc, std::piecewise_construct,
+                                                      std::forward_as_tuple(long_string),
+                                                      std::forward_as_tuple(6))
+    );
+    CHECK( get<0>(other).get_allocator().tag == 42 );
+    CHECK( get<1>(other) == 6 );
+}
+#endif